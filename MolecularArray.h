@@ -2,7 +2,12 @@
 #include <vector>
 #include <algorithm>
 #include <fstream>
+#include <ranges>
+#include <array>
+#include <string_view>
 #include "myArray_class.h"
+#include "myPersistentArray_class.h"
+#include "myRope_class.h"
 using namespace std;
 
 enum NucleicAcid {DNA = 0, RNA = 1} ;
@@ -19,36 +24,52 @@ public:
     }
 };
 
-class MolecularArray
+// Nucleotide sequence analysis on top of any sequence container with myArray's editing interface. The default
+// backing store is myArray<char, FlatStorage>; myRope<char> suits very long sequences that are edited heavily,
+// myArray<char, SharedStorage> lets many copies of one reference sequence share its bases, and
+// myPersistentArray<char> makes every copy a cheap snapshot, so the with*() edits can keep all versions.
+template <typename Sequence = myArray<char, FlatStorage>>
+class basicMolecularArray
 {
 private:
-    myArray<char> sequence;
+    Sequence sequence;
     NucleicAcid type;
-    char complementaryBase(const char &inputBase, NucleicAcid to);
+    char complementaryBase(const char &inputBase, NucleicAcid to) const;
     bool isCorrectNucleotide(char &inputBase, NucleicAcid of) const;
-    string transform(NucleicAcid to);
-    string aminoAcid(const char &base1, const char &base2, const char &base3);
+    string transform(NucleicAcid to) const;
+    string aminoAcid(const char &base1, const char &base2, const char &base3) const;
+    size_t codonIndex(const Pattern<char> &codon, size_t from) const;
 public:
-    MolecularArray(const string &input, NucleicAcid type, bool isFile = false);
-    string transcribe();
-    string reverseTranscribe();
-    string complementSequence(NucleicAcid type);
-    bool isProteinCoding();
-    myArray<string> translate();
-    size_t startCodonIndex(size_t from = 0);
-    size_t stopCodonIndex(size_t from = 0);
-    string splice(const vector<pair<size_t, size_t>> &intronRegions);
-    myArray<pair<size_t, size_t>> findORFs();
+    basicMolecularArray(const string &input, NucleicAcid type, bool isFile = false);
+    string transcribe() const;
+    string reverseTranscribe() const;
+    string complementSequence(NucleicAcid type) const;
+    bool isProteinCoding() const;
+    myArray<string> translate() const;
+    size_t startCodonIndex(size_t from = 0) const;
+    size_t stopCodonIndex(size_t from = 0) const;
+    string splice(const vector<pair<size_t, size_t>> &intronRegions) const;
+    myArray<pair<size_t, size_t>> findORFs() const;
     void induceDeletion(size_t position, size_t how);
     double gcContent() const;
     bool isPalindrome() const;
-    myArray<pair<size_t, size_t>> predictHairpins();
-    void induceSubstitution(size_t position, string &newBases);
-    void induceInsertion(size_t position, string &newBases);
+    myArray<pair<size_t, size_t>> predictHairpins() const;
+    void induceSubstitution(size_t position, const string &newBases);
+    void induceInsertion(size_t position, const string &newBases);
+    basicMolecularArray withSubstitution(size_t position, const string &newBases) const;
+    basicMolecularArray withInsertion(size_t position, const string &newBases) const;
+    basicMolecularArray withDeletion(size_t position, size_t how) const;
+    size_t length() const { return sequence.length(); };
     void writeToFile(const string &filePath) const;
 };
 
-char MolecularArray::complementaryBase(const char &inputBase, NucleicAcid to)
+using MolecularArray = basicMolecularArray<>;
+using RopeMolecularArray = basicMolecularArray<myRope<char>>;
+using SharedMolecularArray = basicMolecularArray<myArray<char, SharedStorage>>;
+using PersistentMolecularArray = basicMolecularArray<myPersistentArray<char>>;
+
+template <typename Sequence>
+char basicMolecularArray<Sequence>::complementaryBase(const char &inputBase, NucleicAcid to) const
 {
     switch (inputBase)
     {
@@ -69,7 +90,8 @@ char MolecularArray::complementaryBase(const char &inputBase, NucleicAcid to)
     }
 }
 
-MolecularArray::MolecularArray(const string &input, NucleicAcid type, bool isFile) : type(type)
+template <typename Sequence>
+basicMolecularArray<Sequence>::basicMolecularArray(const string &input, NucleicAcid type, bool isFile) : type(type)
 {
     string inputSequence;
     if (isFile)
@@ -83,38 +105,39 @@ MolecularArray::MolecularArray(const string &input, NucleicAcid type, bool isFil
         inputSequence = input;
 
     for (char base : inputSequence)
-    {
         if (!isCorrectNucleotide(base, type))
-        {
-            sequence.clear(true);
             throw BaseError("Input sequence is not valid for the specified type.");
-        }
-        sequence.append(base);
-    }
+    // built in one go: every backing store lays out a whole sequence far faster than base-by-base appends
+    sequence = Sequence(inputSequence.data(), inputSequence.size());
 }
 
-string MolecularArray::transcribe()
+template <typename Sequence>
+string basicMolecularArray<Sequence>::transcribe() const
 {
     string outSeq = transform(RNA);
     return outSeq;
 }
 
-string MolecularArray::reverseTranscribe()
+template <typename Sequence>
+string basicMolecularArray<Sequence>::reverseTranscribe() const
 {
     string outSeq = transform(DNA);
     return outSeq;
 }
 
-string MolecularArray::complementSequence(NucleicAcid toType)
+template <typename Sequence>
+string basicMolecularArray<Sequence>::complementSequence(NucleicAcid toType) const
 {
-    ostringstream output;
-    for(size_t j = sequence.length(); j >= 1; --j)
-        output << complementaryBase(sequence.at(j - 1), toType);
-    return output.str();
+    string output;
+    output.reserve(sequence.length());
+    for(char base: sequence | std::views::reverse)
+        output += complementaryBase(base, toType);
+    return output;
 }
 
 
-bool MolecularArray::isCorrectNucleotide(char &inputBase, NucleicAcid of) const
+template <typename Sequence>
+bool basicMolecularArray<Sequence>::isCorrectNucleotide(char &inputBase, NucleicAcid of) const
 {
     switch (inputBase)
     {
@@ -136,36 +159,20 @@ bool MolecularArray::isCorrectNucleotide(char &inputBase, NucleicAcid of) const
 }
 
 
-string MolecularArray::transform(NucleicAcid to)
+template <typename Sequence>
+string basicMolecularArray<Sequence>::transform(NucleicAcid to) const
 {
-    ostringstream output;
+    string output(sequence.begin(), sequence.end());
     if(to == DNA && type == RNA)
-    {
-        for (size_t n = 0; n < sequence.length(); n += 1)
-        {
-            if(sequence.at(n) == 'U')
-                output << 'T';
-            else
-                output << sequence.at(n);
-        }
-        return output.str();
-    }
+        std::ranges::replace(output, 'U', 'T');
     else if(to == RNA && type == DNA)
-    {
-        for (size_t n = 0; n < sequence.length(); n += 1)
-        {
-            if(sequence.at(n) == 'T')
-                output << 'U';
-            else
-                output << sequence.at(n);
-        }
-        return output.str();
-    }
-    return sequence.str("").substr(1, sequence.length() - 2);
+        std::ranges::replace(output, 'T', 'U');
+    return output;
 }
 
 
-bool MolecularArray::isProteinCoding()
+template <typename Sequence>
+bool basicMolecularArray<Sequence>::isProteinCoding() const
 {
     try {
         auto begin = startCodonIndex();
@@ -176,7 +183,8 @@ bool MolecularArray::isProteinCoding()
     }
 }
 
-string MolecularArray::aminoAcid(const char &base1, const char &base2, const char &base3)
+template <typename Sequence>
+string basicMolecularArray<Sequence>::aminoAcid(const char &base1, const char &base2, const char &base3) const
 {
     std::string codon = {base1, base2, base3};
     static const std::unordered_map<std::string, std::string> geneticCode = {
@@ -206,57 +214,56 @@ string MolecularArray::aminoAcid(const char &base1, const char &base2, const cha
     return "Invalid";
 }
 
-size_t MolecularArray::stopCodonIndex(size_t from)
+// Position of the first occurrence of a codon at or after `from`, or length() if there is none.
+template <typename Sequence>
+size_t basicMolecularArray<Sequence>::codonIndex(const Pattern<char> &codon, size_t from) const
 {
-    myArray<char> stopCodons[] = {
-            myArray<char>(type == DNA ? "TAG" : "UAG", 3),
-            myArray<char>(type == DNA ? "TAA" : "UAA", 3),
-            myArray<char>(type == DNA ? "TGA" : "UGA", 3)
-    };
+    return codon.find(sequence.begin(), sequence.end(), from);
+}
 
-    for(auto &c: stopCodons)
-    {
-        try {
-            return sequence.subarrayIndex(c, from);
-        } catch (const out_of_range &e) {
-            continue;
-        }
-    }
+template <typename Sequence>
+size_t basicMolecularArray<Sequence>::stopCodonIndex(size_t from) const
+{
+    // compiled once per program and indexed by NucleicAcid; one pass finds the earliest of the three codons
+    static const PatternSet<char> stopCodons[2] = {PatternSet<char>(std::array<string_view, 3>{"TAG", "TAA", "TGA"}),
+                                                   PatternSet<char>(std::array<string_view, 3>{"UAG", "UAA", "UGA"})};
+    if(size_t found = stopCodons[type].findFirst(sequence.begin(), sequence.end(), from).position;
+            found < sequence.length())
+        return found;
     throw BaseError("No stop codon found.");
 }
 
-size_t MolecularArray::startCodonIndex(size_t from)
+template <typename Sequence>
+size_t basicMolecularArray<Sequence>::startCodonIndex(size_t from) const
 {
-    try {
-        myArray<char> code(type == DNA ? "ATG" : "AUG", 3);
-        return sequence.subarrayIndex(code, from);
-    } catch (out_of_range &e) {
-        throw BaseError("No start codon found.");
-    }
+    static const Pattern<char> startCodons[2] = {{"ATG", 3}, {"AUG", 3}};
+    if(size_t found = codonIndex(startCodons[type], from); found < sequence.length())
+        return found;
+    throw BaseError("No start codon found.");
 }
 
-myArray<string> MolecularArray::translate()
+template <typename Sequence>
+myArray<string> basicMolecularArray<Sequence>::translate() const
 {
     auto ORFs = findORFs();
     myArray<string> output;
     ostringstream read;
-    for(size_t j = 0; j < ORFs.length(); ++j)
+    for(const auto &[beg, end]: ORFs)
     {
-        size_t beg = ORFs.at(j).first;
-        size_t end = ORFs.at(j).second;
         for (size_t i = beg; i <= end - 3; i += 3)
         {
-            if (!output.str().empty())
+            if (i != beg)
                 read << '-';
-            read << aminoAcid(sequence.at(i), sequence.at(i + 1), sequence.at(i + 2));
+            read << aminoAcid(sequence(i), sequence(i + 1), sequence(i + 2));
         }
-        output.append(read.str());
-        read.clear();
+        output.append(std::move(read).str());
+        read.str("");
     }
     return output;
 }
 
-string MolecularArray::splice(const vector<pair<size_t, size_t>> &intronRegions)
+template <typename Sequence>
+string basicMolecularArray<Sequence>::splice(const vector<pair<size_t, size_t>> &intronRegions) const
 {
     if(type == DNA) throw BaseError("DNA cannot be spliced.");
     vector<pair<size_t, size_t>> sortedIntrons = intronRegions;
@@ -270,19 +277,20 @@ string MolecularArray::splice(const vector<pair<size_t, size_t>> &intronRegions)
             throw BaseError("Intron region exceeds sequence length.");
         previousEnd = region.second;
     }
-    ostringstream splicedSequence;
+    string splicedSequence;
     size_t currentIndex = 0;
     for (const auto &region : sortedIntrons)
     {
-        splicedSequence << sequence.str("").substr(currentIndex, region.first);
+        splicedSequence.append(sequence.begin() + currentIndex, sequence.begin() + region.first);
         currentIndex = region.second;
     }
-    splicedSequence << sequence.str("").substr(currentIndex);
-    return splicedSequence.str();
+    splicedSequence.append(sequence.begin() + currentIndex, sequence.end());
+    return splicedSequence;
 }
 
 
-myArray<pair<size_t, size_t>> MolecularArray::findORFs()
+template <typename Sequence>
+myArray<pair<size_t, size_t>> basicMolecularArray<Sequence>::findORFs() const
 {
     myArray<pair<size_t, size_t>> orfs;
     size_t currentPos = 0;
@@ -305,18 +313,21 @@ myArray<pair<size_t, size_t>> MolecularArray::findORFs()
     return orfs;
 }
 
-double MolecularArray::gcContent() const
+template <typename Sequence>
+double basicMolecularArray<Sequence>::gcContent() const
 {
     return static_cast<double>(
-      sequence.countIf([](char input){return input == 'C' || input == 'G'; })) / sequence.length();
+      sequence.countIf(arrayParallel::par, [](char input){return input == 'C' || input == 'G'; })) / sequence.length();
 }
 
-bool MolecularArray::isPalindrome() const
+template <typename Sequence>
+bool basicMolecularArray<Sequence>::isPalindrome() const
 {
-    return sequence == sequence[0, sequence.length() - 1, -1];
+    return std::equal(sequence.begin(), sequence.begin() + sequence.length() / 2, sequence.rbegin());
 }
 
-myArray<pair<size_t, size_t>> MolecularArray::predictHairpins()
+template <typename Sequence>
+myArray<pair<size_t, size_t>> basicMolecularArray<Sequence>::predictHairpins() const
 {
     myArray<pair<size_t, size_t>> hairpins;
     constexpr size_t minStemLength = 3;
@@ -328,7 +339,7 @@ myArray<pair<size_t, size_t>> MolecularArray::predictHairpins()
         {
             size_t stemLength = 0;
             while (i + stemLength < j &&
-              complementaryBase(sequence.at(i + stemLength), type) == sequence.at(j - stemLength))
+              complementaryBase(sequence(i + stemLength), type) == sequence(j - stemLength))
             {
                 stemLength += 1;
                 if (stemLength >= minStemLength && j - (i + stemLength) >= minLoopSize)
@@ -342,48 +353,66 @@ myArray<pair<size_t, size_t>> MolecularArray::predictHairpins()
     return hairpins;
 }
 
-void MolecularArray::induceSubstitution(size_t position, string &newBases)
+template <typename Sequence>
+void basicMolecularArray<Sequence>::induceSubstitution(size_t position, const string &newBases)
 {
     for(const auto &base: newBases)
     {
-        try {
-            sequence[position++] = base;
-        } catch (const std::out_of_range &e)
-        {
+        if(position >= sequence.length())
             throw BaseError("Invalid nucleotide position.\n");
-        }
+        sequence(position++) = base;
     }
 }
 
-void MolecularArray::induceInsertion(size_t position, string &newBases)
+template <typename Sequence>
+void basicMolecularArray<Sequence>::induceInsertion(size_t position, const string &newBases)
 {
     if(position > sequence.length() - 1) throw BaseError("Invalid nucleotide position.\n");
-    for(const auto &base: newBases)
-        sequence.insert(base, position);
+    sequence.insert(position, newBases.begin(), newBases.end());
 }
 
-void MolecularArray::induceDeletion(size_t position, size_t how)
+template <typename Sequence>
+void basicMolecularArray<Sequence>::induceDeletion(size_t position, size_t how)
 {
     if(position > sequence.length() - 1) throw BaseError("Invalid nucleotide position.\n");
-    while(how-- >= 1)
-    {
-        try {
-            sequence.pop(position);
-        } catch (const std::out_of_range &e)
-        {
-            break;
-        }
-    }
+    sequence.erase(position, how);
+}
+
+// The with*() edits return the edited sequence as a new object and leave this one unchanged. With
+// myPersistentArray as the backing store the copy is O(1) and the edit only copies O(log n) chunks.
+template <typename Sequence>
+basicMolecularArray<Sequence> basicMolecularArray<Sequence>::withSubstitution(size_t position, const string &newBases) const
+{
+    basicMolecularArray output(*this);
+    output.induceSubstitution(position, newBases);
+    return output;
+}
+
+template <typename Sequence>
+basicMolecularArray<Sequence> basicMolecularArray<Sequence>::withInsertion(size_t position, const string &newBases) const
+{
+    basicMolecularArray output(*this);
+    output.induceInsertion(position, newBases);
+    return output;
+}
+
+template <typename Sequence>
+basicMolecularArray<Sequence> basicMolecularArray<Sequence>::withDeletion(size_t position, size_t how) const
+{
+    basicMolecularArray output(*this);
+    output.induceDeletion(position, how);
+    return output;
 }
 
 
-void MolecularArray::writeToFile(const string &filePath) const
+template <typename Sequence>
+void basicMolecularArray<Sequence>::writeToFile(const string &filePath) const
 {
     std::ofstream outputFile(filePath);
     if (!outputFile.is_open())
     {
         throw std::ios_base::failure("Failed to open file: " + filePath);
     }
-    outputFile << sequence.str("");
+    std::ranges::copy(sequence, std::ostreambuf_iterator<char>(outputFile));
     outputFile.close();
 }
@@ -125,6 +125,18 @@ TEST(MolecularArrayORFTests, MultipleORFs)
     EXPECT_EQ(orfs.at(1).second, 18);
 }
 
+TEST(MolecularArrayORFTests, EarliestStopCodon)
+{
+    // TAA closes the frame before the TAG that follows it
+    MolecularArray molArray("ATGTAATAGCCC", DNA);
+    EXPECT_EQ(molArray.stopCodonIndex(), 3);
+    EXPECT_EQ(molArray.stopCodonIndex(4), 6);
+    auto orfs = molArray.findORFs();
+    ASSERT_EQ(orfs.length(), 1);
+    EXPECT_EQ(orfs.front().second, 3);
+    EXPECT_THROW(molArray.stopCodonIndex(7), BaseError);
+}
+
 TEST(MolecularArraySplicingTests, RemoveSingleIntron)
 {
     MolecularArray molArray("AUGCGUUACG", RNA);
@@ -132,6 +144,13 @@ TEST(MolecularArraySplicingTests, RemoveSingleIntron)
     EXPECT_EQ(molArray.splice(introns), "AUGUUACG");
 }
 
+TEST(MolecularArraySplicingTests, RemoveMultipleIntrons)
+{
+    MolecularArray molArray("AUGCGUUACGAU", RNA);
+    std::vector<std::pair<size_t, size_t>> introns = {{8, 10}, {3, 5}};
+    EXPECT_EQ(molArray.splice(introns), "AUGUUAAU");
+}
+
 TEST(MolecularArraySplicingTests, OverlappingIntrons)
 {
     MolecularArray molArray("AUGCGUUACG", RNA);
@@ -170,3 +189,85 @@ TEST(MolecularArrayEditTests, InduceDeletion)
     molArray.induceDeletion(3, 2);
     EXPECT_EQ(molArray.complementSequence(DNA), "CGTACAT");
 }
+
+TEST(MolecularArrayTranslationTests, TranslateORFs)
+{
+    MolecularArray molArray("AUGUUUUAGAUGGGCUGA", RNA);
+    auto proteins = molArray.translate();
+    ASSERT_EQ(proteins.length(), 2);
+    EXPECT_EQ(proteins.at(0), "Met-Phe");
+    EXPECT_EQ(proteins.at(1), "Met-Gly");
+}
+
+TEST(MolecularArrayBackingStoreTests, RopeMatchesFlatArray)
+{
+    std::string bases = "ATGCGTACGTAGATGGGCTGACCGTTAAGGCTAGCATGAAATTTTAG";
+    MolecularArray flat(bases, DNA);
+    RopeMolecularArray rope(bases, DNA);
+    EXPECT_EQ(rope.complementSequence(DNA), flat.complementSequence(DNA));
+    EXPECT_EQ(rope.startCodonIndex(), flat.startCodonIndex());
+    EXPECT_EQ(rope.stopCodonIndex(), flat.stopCodonIndex());
+    EXPECT_DOUBLE_EQ(rope.gcContent(), flat.gcContent());
+    std::string insert = "CCC";
+    std::string substitute = "G";
+    flat.induceInsertion(5, insert);
+    rope.induceInsertion(5, insert);
+    flat.induceDeletion(20, 4);
+    rope.induceDeletion(20, 4);
+    flat.induceSubstitution(0, substitute);
+    rope.induceSubstitution(0, substitute);
+    EXPECT_EQ(rope.complementSequence(DNA), flat.complementSequence(DNA));
+    EXPECT_EQ(rope.translate().length(), flat.translate().length());
+}
+
+TEST(MolecularArrayBackingStoreTests, CodonSearchOnLongRope)
+{
+    // the codons sit at the end of 4 Mbp, so the searches read the whole rope; each chunk must be found once,
+    // not once per base
+    std::string bases;
+    for(int i = 0; i < 1000000; ++i)
+        bases += "CGTC";
+    bases += "ATGCCCTAA";
+    MolecularArray flat(bases, DNA);
+    RopeMolecularArray rope(bases, DNA);
+    PersistentMolecularArray persistent(bases, DNA);
+    EXPECT_EQ(flat.startCodonIndex(), 4000000);
+    EXPECT_EQ(rope.startCodonIndex(), flat.startCodonIndex());
+    EXPECT_EQ(persistent.startCodonIndex(), flat.startCodonIndex());
+    EXPECT_EQ(rope.stopCodonIndex(), flat.stopCodonIndex());
+    EXPECT_EQ(persistent.stopCodonIndex(), flat.stopCodonIndex());
+    EXPECT_THROW(rope.startCodonIndex(4000001), BaseError);
+}
+
+TEST(MolecularArrayBackingStoreTests, SharedCopiesAreIndependent)
+{
+    SharedMolecularArray reference("ATGCGTACGTAGATGGGCTGA", DNA);
+    std::vector<SharedMolecularArray> workers(8, reference);
+    std::string insert = "CCC";
+    workers[0].induceInsertion(3, insert);
+    workers[1].induceDeletion(0, 3);
+    EXPECT_EQ(workers[0].complementSequence(DNA), "TCAGCCCATCTACGTACGGGGCAT");
+    EXPECT_EQ(workers[1].complementSequence(DNA), "TCAGCCCATCTACGTACG");
+    EXPECT_EQ(workers[7].complementSequence(DNA), reference.complementSequence(DNA));
+    EXPECT_DOUBLE_EQ(workers[7].gcContent(), MolecularArray("ATGCGTACGTAGATGGGCTGA", DNA).gcContent());
+}
+
+TEST(MolecularArrayBackingStoreTests, PersistentVersions)
+{
+    std::string bases = "ATGCGTACGTAGATGGGCTGACCGTTAAGGCTAGCATGAAATTTTAG";
+    PersistentMolecularArray reference(bases, DNA);
+    MolecularArray flat(bases, DNA);
+    auto inserted = reference.withInsertion(5, "CCC");
+    auto deleted = inserted.withDeletion(20, 4);
+    auto substituted = deleted.withSubstitution(0, "G");
+    EXPECT_EQ(reference.length(), bases.size());
+    EXPECT_EQ(inserted.length(), bases.size() + 3);
+    EXPECT_EQ(reference.complementSequence(DNA), flat.complementSequence(DNA));
+    flat.induceInsertion(5, "CCC");
+    EXPECT_EQ(inserted.complementSequence(DNA), flat.complementSequence(DNA));
+    flat.induceDeletion(20, 4);
+    flat.induceSubstitution(0, "G");
+    EXPECT_EQ(substituted.complementSequence(DNA), flat.complementSequence(DNA));
+    EXPECT_EQ(substituted.translate().length(), flat.translate().length());
+    EXPECT_DOUBLE_EQ(substituted.gcContent(), flat.gcContent());
+}
@@ -1,3 +1,4 @@
+#include <utility>
 
 
 template<typename C>
@@ -12,7 +13,7 @@ public:
     Node(C input, Node<C> *prev);
     Node(C input, Node<C> *prev, Node<C> *next);
     Node(Node<C> &other);
-    Node(Node<C> &&other);
+    Node(Node<C> &&other) noexcept;
     ~Node();
     bool operator >(const Node &second) const;
     bool operator <(const Node &second) const;
@@ -32,28 +33,26 @@ public:
     void set_next(Node<C> *input);
     void set_previous(Node<C> *input);
     const C &get_data() const;
+    C &get_data();
     Node *operator*() {return this;};
 };
 
 
 
 template<typename C>
-Node<C>::Node(C input)
+Node<C>::Node(C input) : data(std::move(input))
 {
-    data = input;
 }
 
 template<typename C>
-Node<C>::Node(C input, Node *prev)
+Node<C>::Node(C input, Node *prev) : data(std::move(input))
 {
-    data = input;
     this->prev = prev;
 }
 
 template<typename C>
-Node<C>::Node(C input, Node *prev, Node *next)
+Node<C>::Node(C input, Node *prev, Node *next) : data(std::move(input))
 {
-    data = input;
     this->prev = prev;
     this->next = next;
 }
@@ -65,10 +64,10 @@ Node<C>::Node(Node<C> &other)
 }
 
 template<typename C>
-Node<C>::Node(Node<C> &&other)
+Node<C>::Node(Node<C> &&other) noexcept : data(std::move(other.data)), next(other.next), prev(other.prev)
 {
-    data = other.get_data();
-    delete *other;
+    other.set_next(nullptr);
+    other.set_previous(nullptr);
 }
 
 template<typename C>
@@ -80,6 +79,12 @@ const C &Node<C>::get_data() const
     return data;
 }
 
+template<typename C>
+C &Node<C>::get_data()
+{
+    return data;
+}
+
 
 template<typename C>
 void Node<C>::set_next(Node<C> *input)
@@ -174,7 +179,7 @@ Node<C> &Node<C>::operator =(Node<C> &&second)
 {
     if(this != &second)
     {
-        data = second.get_data();
+        data = std::move(second.get_data());
         prev = second.get_previous();
         next = second.get_next();
         second.set_previous(nullptr);
@@ -1,419 +1,1376 @@
+#pragma once
 #include "Node_Class.h"
+#include "myArray_hash.h"
+#include "myArray_iterator.h"
+#include "myArray_parallel.h"
+#include "myArray_pattern.h"
+#include "myArray_simd.h"
+#include "myArray_slice.h"
+#include "myArray_sort.h"
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <new>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <functional>
+#include <stdexcept>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+#if __has_include(<generator>)
+#include <generator>
+#endif
 
+// Storage policies: LinkedStorage keeps every element inside a Node<T> with prev/next links,
+// FlatStorage keeps a plain contiguous T buffer (sizeof(T) bytes per element),
+// GapStorage keeps a T buffer whose free capacity sits at the last edit position (a gap buffer),
+// SharedStorage keeps a contiguous T buffer that copies share until one of them is modified (copy-on-write),
+// SmallStorage<N> keeps up to N elements inside the array object and only goes to the heap beyond that.
+struct LinkedStorage {};
+struct FlatStorage {};
+struct GapStorage {};
+struct SharedStorage {};
+template <size_t N = 16>
+struct SmallStorage
+{
+    static constexpr size_t inlineCapacity = N;
+};
+
+// Default allocator of myArray: plain malloc/free, plus reallocate() which lets trivially copyable
+// buffers grow in place instead of being copied.
 template <typename T>
+struct mallocAllocator
+{
+    using value_type = T;
+    mallocAllocator() = default;
+    template <typename U>
+    mallocAllocator(const mallocAllocator<U> &) noexcept {}
+    T *allocate(size_t n);
+    void deallocate(T *pointer, size_t) noexcept { std::free(pointer); };
+    T *reallocate(T *pointer, size_t, size_t n);
+    template <typename U>
+    bool operator==(const mallocAllocator<U> &) const noexcept { return true; };
+};
+
+template <typename T, typename Storage = LinkedStorage, typename Allocator = mallocAllocator<T>>
 class myArray
 {
 private:
-    Node<T> *buffer;
-    Node<T> *first;
-    Node<T> *last;
+    static constexpr bool linked = std::is_same_v<Storage, LinkedStorage>;
+    static constexpr bool gapped = std::is_same_v<Storage, GapStorage>;
+    static constexpr bool shared = std::is_same_v<Storage, SharedStorage>;
+    static constexpr size_t inlineCapacity = [] {
+        if constexpr (requires { Storage::inlineCapacity; })
+            return Storage::inlineCapacity;
+        else
+            return size_t(0);
+    }();
+    static constexpr bool small = inlineCapacity > 0;
+    // cells an empty array starts with; small arrays start in their inline cells, however few there are
+    static constexpr size_t defaultCapacity = small ? inlineCapacity : 10;
+    static constexpr bool contiguous = std::is_same_v<Storage, FlatStorage> || shared || small;
+    static constexpr bool vectorSearch = contiguous && arraySimd::vectorizable<T>;
+    using Cell = std::conditional_t<linked, Node<T>, T>;
+    using CellAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Cell>;
+    using CellTraits = std::allocator_traits<CellAllocator>;
+    using CountAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<std::atomic<size_t>>;
+    // operator[] cannot hand out writable cells of a buffer other arrays may be reading
+    using CellReference = std::conditional_t<shared, const Cell &, Cell &>;
+    static constexpr bool reallocatable = !small && std::is_trivially_copyable_v<Cell> &&
+            requires (CellAllocator &a, Cell *p, size_t n) { a.reallocate(p, n, n); };
+    static constexpr bool stealable = CellTraits::propagate_on_container_move_assignment::value ||
+            CellTraits::is_always_equal::value;
+    [[no_unique_address]] CellAllocator cellAllocator;
+    Cell *buffer;
     size_t len{0};
     size_t allocated;
+    double growth{2.0};
+    // GapStorage only: number of elements stored after the gap, i.e. in the last `tail` cells of the buffer
+    struct noGap {};
+    [[no_unique_address]] std::conditional_t<gapped, size_t, noGap> tail{};
+    // SharedStorage only: number of arrays using `buffer`; null only while there is no buffer
+    struct noShare {};
+    [[no_unique_address]] std::conditional_t<shared, std::atomic<size_t> *, noShare> owners{};
+    // SmallStorage only: room for inlineCapacity cells inside the object, used as the buffer while they suffice
+    struct noInline {};
+    struct inlineCells
+    {
+        alignas(Cell) unsigned char bytes[std::max<size_t>(inlineCapacity, 1) * sizeof(Cell)];
+    };
+    [[no_unique_address]] std::conditional_t<small, inlineCells, noInline> local;
+    Cell *localCells();
+    Cell *allocateCells(size_t count);
+    void deallocateCells(Cell *cells, size_t count) noexcept;
     void extendMemory(size_t newAlloc);
+    void grow(size_t needed);
     void initialMemory(size_t alloc);
-    void insertionSort(bool reverse = false);
+    template <typename Sorter>
+    void sortValues(Sorter sorter);
+    template <typename... Args>
+    void construct(size_t index, Args &&...args);
+    void steal(myArray &other) noexcept;
+    std::atomic<size_t> *newCount();
+    bool sharedBuffer() const;
+    bool owns(const T *element) const;
+    void share(const myArray &other) noexcept;
+    void release() noexcept;
+    void detach(size_t capacity = 0);
+    void relink(size_t from = 0);
+    void relocate(size_t from, size_t to) noexcept;
+    void shiftRight(size_t from, size_t count) noexcept;
+    void shiftLeft(size_t from, size_t count) noexcept;
+    template <typename Build>
+    void insertCells(size_t pos, size_t count, Build build);
+    size_t physical(size_t index) const;
+    void moveGap(size_t pos) noexcept;
+    void closeGap() noexcept;
+    size_t position(long long index) const;
+    T &value(size_t index);
+    const T &value(size_t index) const;
+    template <typename Policy>
+    unsigned policyChunks() const;
+    template <typename Policy, typename Predicate>
+    bool anyMatch(Predicate &pred, bool expected) const;
+    template <typename, typename, typename>
+    friend class myArray;
+    friend class arraySlice<myArray>;
 public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    // FlatStorage iterates with plain pointers (std::contiguous_iterator), LinkedStorage with nodeIterator,
+    // GapStorage with indexIterator.
+    using iterator = std::conditional_t<linked, nodeIterator<T, false>,
+            std::conditional_t<gapped, indexIterator<myArray, false>, T *>>;
+    using const_iterator = std::conditional_t<linked, nodeIterator<T, true>,
+            std::conditional_t<gapped, indexIterator<myArray, true>, const T *>>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    // Array of another element type with the same storage policy and a rebound allocator, as returned by map().
+    template <typename U>
+    using rebind = myArray<U, Storage, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+    template <typename U, typename F>
+    using mapped = std::conditional_t<std::is_void_v<U>, std::remove_cvref_t<std::invoke_result_t<F &, const T &>>, U>;
+
     myArray();
+    explicit myArray(const Allocator &allocator);
     myArray(T &initial);
-    myArray(const T *inputArray, size_t len2);
+    myArray(const T *inputArray, size_t len2, const Allocator &allocator = Allocator());
     myArray(const myArray &inputArray, size_t len2 = 0);
-    myArray(myArray &&inputArray);
+    myArray(myArray &&inputArray) noexcept;
     ~myArray();
     size_t length() const { return len; };
+    size_t size() const { return len; };
+    T *data() requires contiguous { detach(); return buffer; };
+    const T *data() const requires contiguous { return buffer; };
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const { return begin(); };
+    const_iterator cend() const { return end(); };
+    reverse_iterator rbegin() { return reverse_iterator(end()); };
+    reverse_iterator rend() { return reverse_iterator(begin()); };
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); };
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); };
     size_t memory() const { return allocated; };
-    Node<T> &operator[](long long index) const;
+    size_t useCount() const requires shared { return owners ? owners->load(std::memory_order_relaxed) : 1; };
+    Allocator get_allocator() const { return Allocator(cellAllocator); };
+    double growthFactor() const { return growth; };
+    void setGrowthFactor(double factor);
+    void reserve(size_t capacity);
+    void shrink_to_fit();
+    CellReference operator[](long long index) const;
     T pop(long long index = -1);
+    std::optional<T> try_pop(long long index = -1);
     size_t index(const T &element, size_t from = 0) const;
+    std::optional<size_t> try_index(const T &element, size_t from = 0) const;
     bool in(const T &element) const;
     size_t count(const T &element) const;
     void append(const T &element);
+    void append(T &&element);
+    template <typename... Args>
+    T &emplace_back(Args &&...args);
     void reverse();
     void clear(bool shrink = true);
-    myArray<T> copy() const;
+    myArray copy() const;
     void sort(bool reverse = false);
+    template <typename Compare> requires std::predicate<Compare &, const T &, const T &>
+    void sort(Compare comp);
+    template <typename Compare, typename Projection> requires std::invocable<Projection &, const T &>
+    void sort(Compare comp, Projection proj);
+    void stable_sort(bool reverse = false);
+    template <typename Compare> requires std::predicate<Compare &, const T &, const T &>
+    void stable_sort(Compare comp);
+    template <typename Compare, typename Projection> requires std::invocable<Projection &, const T &>
+    void stable_sort(Compare comp, Projection proj);
     std::string str(std::string del = ", ") const;
-    void extend(const myArray<T> &second);
-    void vectorise(T (*func) (T));
-    bool isSubarray(myArray<T> &other) const;
-    int countIf(bool (*func) (T)) const;
+    void extend(const myArray &second);
+    template <typename F> requires std::invocable<F &, T &>
+    void vectorise(F func);
+    template <typename Policy, typename F>
+            requires arrayParallel::executionPolicy<Policy> && std::invocable<F &, T &>
+    void vectorise(Policy &&policy, F func);
+    template <typename U = void, typename F> requires std::invocable<F &, const T &>
+    rebind<mapped<U, F>> map(F func) const;
+    template <typename U = void, typename Policy, typename F>
+            requires arrayParallel::executionPolicy<Policy> && std::invocable<F &, const T &>
+    rebind<mapped<U, F>> map(Policy &&policy, F func) const;
+    template <typename S, typename A>
+    bool isSubarray(const myArray<T, S, A> &other) const;
+    bool isSubarray(const Pattern<T> &pattern) const;
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    size_t countIf(Predicate pred) const;
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    size_t countIf(Policy &&policy, Predicate pred) const;
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    bool anyOf(Predicate pred) const { return anyMatch<arrayParallel::sequencedPolicy>(pred, true); };
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    bool allOf(Predicate pred) const { return !anyMatch<arrayParallel::sequencedPolicy>(pred, false); };
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    bool noneOf(Predicate pred) const { return !anyMatch<arrayParallel::sequencedPolicy>(pred, true); };
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    bool anyOf(Policy &&, Predicate pred) const { return anyMatch<Policy>(pred, true); };
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    bool allOf(Policy &&, Predicate pred) const { return !anyMatch<Policy>(pred, false); };
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    bool noneOf(Policy &&, Predicate pred) const { return !anyMatch<Policy>(pred, true); };
     void insert(T element, long long index = 0);
+    template <std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(size_t pos, It first, It last);
+    void insert(size_t pos, size_t count, const T &element);
+    void erase(size_t pos, size_t count = 1);
     T front() const;
     T back() const;
-    void operator+=(const myArray<T> &second);
-    bool operator==(const myArray<T> &second) const;
+    void operator+=(const myArray &second);
+    bool operator==(const myArray &second) const;
+    size_t hash() const requires arrayHash::hashable<T>;
     bool operator!() const { return len == 0; };
     std::ostringstream &operator<<(std::ostringstream &in);
-    myArray<T> &operator=(const myArray &inputArray);
-    myArray<T> &operator=(myArray &&inputArray) noexcept ;
-    myArray<T> operator+(myArray<T> &other);
-    size_t subarrayIndex(myArray<T> &other, size_t from = 0) const;
+    myArray &operator=(const myArray &inputArray);
+    myArray &operator=(myArray &&inputArray) noexcept(stealable);
+    myArray operator+(myArray &other);
+    template <typename S, typename A>
+    size_t subarrayIndex(const myArray<T, S, A> &other, size_t from = 0) const;
+    size_t subarrayIndex(const Pattern<T> &pattern, size_t from = 0) const;
+    template <typename S, typename A>
+    std::optional<size_t> find(const myArray<T, S, A> &other, size_t from = 0) const;
+    std::optional<size_t> find(const Pattern<T> &pattern, size_t from = 0) const;
+    template <typename F> requires std::invocable<F &, size_t>
+    void findAll(const Pattern<T> &pattern, F f) const { pattern.forEachMatch(begin(), end(), f); };
+    template <std::output_iterator<size_t> Out>
+    Out findAll(const Pattern<T> &pattern, Out out) const;
+#if __cpp_lib_generator
+    std::generator<size_t> findAll(const Pattern<T> &pattern) const;
+#endif
+    template <typename F>
+    void forEachMatch(const PatternSet<T> &patterns, F f) const { patterns.forEachMatch(begin(), end(), f); };
+    std::vector<typename PatternSet<T>::Match> matches(const PatternSet<T> &patterns) const;
     void remove(T element);
-    myArray<T> operator[](long long start, long long end, long long step = 1) const;
-    T at(long long index) const;
+    arraySlice<myArray> operator[](long long start, long long end, long long step = 1) const;
+    arraySlice<myArray> slice(long long start, long long end, long long step = 1) const;
+    const T &at(long long index) const;
+    T &operator()(size_t index);
+    const T &operator()(size_t index) const;
     T max() const;
     T min() const;
-    T sum() const;
+    std::pair<T, T> minmax() const;
+    std::optional<T> try_max() const;
+    std::optional<T> try_min() const;
+    std::optional<std::pair<T, T>> try_minmax() const;
+    T sum(bool compensated = false) const;
+};
+
+// Lets myArray key std::unordered_map and std::unordered_set directly.
+template <typename T, typename Storage, typename Allocator> requires arrayHash::hashable<T>
+struct std::hash<myArray<T, Storage, Allocator>>
+{
+    size_t operator()(const myArray<T, Storage, Allocator> &array) const { return array.hash(); }
 };
 
+// myArray drawing its memory from a std::pmr::memory_resource, e.g. a monotonic arena.
+template <typename T, typename Storage = LinkedStorage>
+using pmrArray = myArray<T, Storage, std::pmr::polymorphic_allocator<T>>;
+
 
 template<typename T>
-T myArray<T>::sum() const
+T *mallocAllocator<T>::allocate(size_t n)
 {
-    T result;
+    auto pointer = (T *) std::malloc(n * sizeof(T));
+    if (!pointer && n > 0)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+template<typename T>
+T *mallocAllocator<T>::reallocate(T *pointer, size_t, size_t n)
+{
+    // realloc can grow in place, and glibc serves large blocks with mremap instead of copying
+    auto newPointer = (T *) std::realloc(pointer, n * sizeof(T));
+    if (!newPointer)
+        throw std::bad_alloc();
+    return newPointer;
+}
+
+
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::sum(bool compensated) const
+{
+    if constexpr (std::is_floating_point_v<T>)
+        if (compensated)
+        {
+            // per-chunk Neumaier sums, merged into one running sum and correction in chunk order
+            std::vector<std::pair<T, T>> partial(contiguous ? arrayParallel::chunksFor(len) : 1);
+            if constexpr (contiguous)
+                arrayParallel::forChunks(len, partial.size(), [&](size_t begin, size_t end, unsigned chunk) {
+                    partial[chunk] = arraySimd::compensatedSum(buffer + begin, end - begin);
+                });
+            else
+                for(size_t m = 0; m < len; ++m)
+                    partial[0] = arraySimd::compensatedSum(&value(m), 1, partial[0].first, partial[0].second);
+            T result{}, correction{};
+            for(auto &[chunkSum, chunkCorrection]: partial)
+            {
+                std::tie(result, correction) = arraySimd::compensatedSum(&chunkSum, 1, result, correction);
+                correction += chunkCorrection;
+            }
+            return result + correction;
+        }
+    if constexpr (contiguous && arraySimd::reducible<T>)
+    {
+        std::vector<T> partial(arrayParallel::chunksFor(len));
+        arrayParallel::forChunks(len, partial.size(), [&](size_t begin, size_t end, unsigned chunk) {
+            partial[chunk] = arraySimd::sum(buffer + begin, end - begin);
+        });
+        return arraySimd::sumScalar(partial.data(), partial.size());
+    }
+    T result{};
     for(size_t m = 0; m < len; m += 1)
-        result = result + buffer[m].get_data();
+        result = result + value(m);
     return result;
 }
 
 
-template<typename T>
-T myArray<T>::at(long long int index) const
+template<typename T, typename Storage, typename Allocator>
+const T &myArray<T, Storage, Allocator>::at(long long int index) const
 {
-    return this->operator[](index).get_data();
+    return value(position(index));
 }
 
+// Unchecked access for inner loops: no negative indices and no bounds check unless MYARRAY_CHECKED is defined.
+template<typename T, typename Storage, typename Allocator>
+T &myArray<T, Storage, Allocator>::operator()(size_t index)
+{
+#ifdef MYARRAY_CHECKED
+    if(index >= len)
+        throw std::out_of_range("Index is out of range.");
+#endif
+    detach();
+    return value(index);
+}
 
-template<typename T>
-myArray<T> myArray<T>::operator[](long long start, long long end, long long step) const
+template<typename T, typename Storage, typename Allocator>
+const T &myArray<T, Storage, Allocator>::operator()(size_t index) const
 {
-    if(start < 0)
-        start += len;
-    if(end < 0)
-        end += len;
-    if(start >= len || start < 0 || end < 0 || end >= len || step == 0 || start > end)
+#ifdef MYARRAY_CHECKED
+    if(index >= len)
         throw std::out_of_range("Index is out of range.");
-    myArray<T> output;
-    for(size_t i = step > 0 ? start : end; step > 0 ? i <= end : i >= start; i += step)
+#endif
+    return value(index);
+}
+
+
+template<typename T, typename Storage, typename Allocator>
+arraySlice<myArray<T, Storage, Allocator>> myArray<T, Storage, Allocator>::operator[](long long start, long long end, long long step) const
+{
+    return arraySlice<myArray>(*this, start, end, step);
+}
+
+template<typename T, typename Storage, typename Allocator>
+arraySlice<myArray<T, Storage, Allocator>> myArray<T, Storage, Allocator>::slice(long long start, long long end, long long step) const
+{
+    return arraySlice<myArray>(*this, start, end, step);
+}
+
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::insert(T element, long long int index)
+{
+    insert(position(index), size_t(1), element);
+}
+
+// Makes room for `count` elements before `pos` and calls build(cell) to construct each of them in buffer[cell].
+// If a build throws, the elements built so far are destroyed and the array is restored.
+template<typename T, typename Storage, typename Allocator>
+template<typename Build>
+void myArray<T, Storage, Allocator>::insertCells(size_t pos, size_t count, Build build)
+{
+    if(pos > len)
+        throw std::out_of_range("Index is out of range.");
+    if(count == 0)
+        return;
+    detach(len + count);
+    if constexpr (gapped)
     {
-        output.append(buffer[i].get_data());
-        if(step == -1 && i == 0) break;
+        if(allocated - len < count)
+        {
+            closeGap();
+            grow(len + count);
+        }
+        moveGap(pos);
     }
-    return output;
+    else
+    {
+        grow(len + count);
+        shiftRight(pos, count);
+    }
+    size_t built = 0;
+    try {
+        for(; built < count; ++built)
+            build(pos + built);
+    } catch (...) {
+        for(size_t i = 0; i < built; ++i)
+            std::destroy_at(buffer + pos + i);
+        if constexpr (!gapped)
+        {
+            len += count;
+            shiftLeft(pos, count);
+            len -= count;
+        }
+        throw;
+    }
+    len += count;
+    relink(pos > 0 ? pos - 1 : 0);
 }
 
+template<typename T, typename Storage, typename Allocator>
+template<std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+void myArray<T, Storage, Allocator>::insert(size_t pos, It first, It last)
+{
+    using Reference = std::iter_reference_t<It>;
+    if constexpr (std::is_lvalue_reference_v<Reference> && std::is_same_v<std::remove_cvref_t<Reference>, T>)
+        if(first != last && owns(std::addressof(*first)))
+        {
+            // the range is part of this array, which is about to be shifted or reallocated, so insert a copy
+            std::vector<T> copied(first, last);
+            insert(pos, copied.begin(), copied.end());
+            return;
+        }
+    insertCells(pos, static_cast<size_t>(std::distance(first, last)), [&](size_t cell) {
+        construct(cell, *first);
+        ++first;
+    });
+}
 
-template<typename T>
-void myArray<T>::insert(T element, long long int index)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::insert(size_t pos, size_t count, const T &element)
 {
-    this->operator[](index);
-    append(element);
-    for(size_t i = len - 2; i >= index; --i)
-        buffer[i + 1] = buffer[i];
-    buffer[index] = element;
+    // element may live in this array, so copy it before the buffer moves
+    T copied(element);
+    insertCells(pos, count, [&](size_t cell) { construct(cell, copied); });
 }
 
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::erase(size_t pos, size_t count)
+{
+    if(pos > len)
+        throw std::out_of_range("Index is out of range.");
+    count = std::min(count, len - pos);
+    if(count == 0)
+        return;
+    detach();
+    if constexpr (gapped)
+    {
+        // with the gap right after the erased run, erasing just widens the gap
+        moveGap(pos + count);
+        for(size_t i = pos; i < pos + count; ++i)
+            std::destroy_at(buffer + i);
+        len -= count;
+        return;
+    }
+    for(size_t i = pos; i < pos + count; ++i)
+        std::destroy_at(buffer + i);
+    shiftLeft(pos, count);
+    len -= count;
+    relink(pos > 0 ? pos - 1 : 0);
+}
 
-template<typename T>
-void myArray<T>::operator+=(const myArray<T> &second)
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::operator+=(const myArray<T, Storage, Allocator> &second)
 {
     extend(second);
 }
 
-template<typename T>
-bool myArray<T>::operator==(const myArray<T> &second) const
+template<typename T, typename Storage, typename Allocator>
+bool myArray<T, Storage, Allocator>::operator==(const myArray<T, Storage, Allocator> &second) const
 {
-    if(len != second.length())
+    if(len != second.len)
         return false;
-    for(size_t n = 0; n < len; ++n)
-        if(second[n] != buffer[n])
-            return false;
-    return true;
+    // elements whose value is exactly their bytes are compared with (vectorised) memcmp
+    if constexpr (contiguous && std::has_unique_object_representations_v<T>)
+        return len == 0 || buffer == second.buffer || std::memcmp(buffer, second.buffer, len * sizeof(T)) == 0;
+    else
+        return std::equal(begin(), end(), second.begin());
 }
 
-template<typename T>
-T myArray<T>::back() const
+// Equal arrays have equal hashes, so the result can key unordered containers through std::hash<myArray>.
+// Byte-comparable elements in contiguous storage are hashed as one block of memory; any other element type
+// combines std::hash<T> of every element. Wrap the array in a HashedArray to keep the result between calls.
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::hash() const requires arrayHash::hashable<T>
 {
-    return last->get_data();
+    if constexpr (contiguous && std::has_unique_object_representations_v<T>)
+        return arrayHash::bytes(buffer, len * sizeof(T));
+    else
+    {
+        arrayHash::combiner combined;
+        for(const T &element: *this)
+            combined.add(std::hash<T>{}(element));
+        return combined.finish(len);
+    }
 }
 
-template<typename T>
-T myArray<T>::front() const
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::back() const
 {
-    return first->get_data();
+    if (len == 0) throw std::out_of_range("Empty list.");
+    return value(len - 1);
 }
 
-template<typename T>
-int myArray<T>::countIf(bool (*func)(T)) const
-{
-    int output = 0;
-    if(first == nullptr) return output;
-    auto iter = first;
-    do {
-        if(func(iter->get_data()))
-            output += 1;
-        iter = iter->get_next();
-    } while(iter != nullptr);
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::front() const
+{
+    if (len == 0) throw std::out_of_range("Empty list.");
+    return value(0);
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Predicate> requires std::predicate<Predicate &, const T &>
+size_t myArray<T, Storage, Allocator>::countIf(Predicate pred) const
+{
+    return countIf(arrayParallel::seq, std::move(pred));
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Policy, typename Predicate>
+        requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+size_t myArray<T, Storage, Allocator>::countIf(Policy &&, Predicate pred) const
+{
+    std::vector<size_t> partial(policyChunks<Policy>());
+    arrayParallel::forChunks(len, partial.size(), [&](size_t begin, size_t end, unsigned chunk) {
+        size_t output = 0;
+        for(size_t i = begin; i < end; ++i)
+            output += static_cast<bool>(std::invoke(pred, value(i)));
+        partial[chunk] = output;
+    });
+    size_t output = 0;
+    for(size_t count: partial)
+        output += count;
     return output;
 }
 
-template<typename T>
-void myArray<T>::initialMemory(size_t alloc)
+// True if pred(element) == expected for some element. Stops at the first hit; worker threads poll a shared
+// flag between blocks so they also stop once any of them has found one.
+template<typename T, typename Storage, typename Allocator>
+template<typename Policy, typename Predicate>
+bool myArray<T, Storage, Allocator>::anyMatch(Predicate &pred, bool expected) const
 {
-    buffer = (Node<T>*)std::malloc(alloc * sizeof(Node<T>));
-    if (!buffer)
-        throw std::bad_alloc();
+    unsigned chunks = policyChunks<Policy>();
+    if(chunks == 1)
+    {
+        for(size_t i = 0; i < len; ++i)
+            if(static_cast<bool>(std::invoke(pred, value(i))) == expected)
+                return true;
+        return false;
+    }
+    constexpr size_t block = 1024;
+    std::atomic<bool> found{false};
+    arrayParallel::forChunks(len, chunks, [&](size_t begin, size_t end, unsigned) {
+        for(size_t i = begin; i < end && !found.load(std::memory_order_relaxed); i += block)
+            for(size_t j = i; j < std::min(i + block, end); ++j)
+                if(static_cast<bool>(std::invoke(pred, value(j))) == expected)
+                {
+                    found.store(true, std::memory_order_relaxed);
+                    return;
+                }
+    });
+    return found.load();
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::initialMemory(size_t alloc)
+{
+    if constexpr (small)
+        alloc = std::max(alloc, inlineCapacity);
+    buffer = alloc > 0 ? allocateCells(alloc) : nullptr;
     allocated = alloc;
+    if constexpr (shared)
+        owners = newCount();
 }
 
+template<typename T, typename Storage, typename Allocator>
+template<typename... Args>
+void myArray<T, Storage, Allocator>::construct(size_t index, Args &&...args)
+{
+    if constexpr (linked)
+        ::new (static_cast<void*>(buffer + index)) Cell(T(std::forward<Args>(args)...));
+    else
+        ::new (static_cast<void*>(buffer + index)) Cell(std::forward<Args>(args)...);
+}
 
-template<typename T>
-myArray<T>::myArray(): buffer(nullptr), first(nullptr), last(nullptr)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::steal(myArray &other) noexcept
+{
+    if constexpr (small)
+        if(other.buffer == other.localCells())
+        {
+            // inline elements cannot change owner, so they are moved into this array's own inline cells
+            for(size_t i = 0; i < other.len; ++i)
+            {
+                ::new (static_cast<void*>(localCells() + i)) Cell(std::move(other.buffer[i]));
+                std::destroy_at(other.buffer + i);
+            }
+            other.buffer = localCells();
+        }
+    buffer = other.buffer;
+    len = other.len;
+    allocated = other.allocated;
+    growth = other.growth;
+    other.buffer = nullptr;
+    other.len = 0;
+    other.allocated = 0;
+    if constexpr (gapped)
+    {
+        tail = other.tail;
+        other.tail = 0;
+    }
+    if constexpr (shared)
+    {
+        owners = other.owners;
+        other.owners = nullptr;
+    }
+}
+
+template<typename T, typename Storage, typename Allocator>
+std::atomic<size_t> *myArray<T, Storage, Allocator>::newCount()
 {
-    initialMemory(10);
+    CountAllocator countAllocator(cellAllocator);
+    auto count = std::allocator_traits<CountAllocator>::allocate(countAllocator, 1);
+    return std::construct_at(count, 1);
 }
 
-template<typename T>
-myArray<T>::myArray(T &initial): buffer(nullptr), first(nullptr), last(nullptr)
+// True if another array still uses this array's buffer. The acquire load pairs with release() in the other
+// owners, so once this returns false their reads of the buffer are finished and it can be written.
+template<typename T, typename Storage, typename Allocator>
+bool myArray<T, Storage, Allocator>::sharedBuffer() const
 {
-    initialMemory(10);
-    append(initial);
-    first = *buffer[0];
-    last = first;
+    if constexpr (shared)
+        return owners && owners->load(std::memory_order_acquire) > 1;
+    else
+        return false;
 }
 
-template<typename T>
-myArray<T>::myArray(const T* inputArray, size_t len2): buffer(nullptr),first(nullptr),last(nullptr),len(len2)
+// True if `element` lives in this array's buffer, e.g. an argument that was read from the array itself.
+template<typename T, typename Storage, typename Allocator>
+bool myArray<T, Storage, Allocator>::owns(const T *element) const
 {
-    initialMemory(2 * len2);
-    Node<T> *prev = nullptr;
-    for(size_t j = 0; j < len2; ++j)
+    auto address = reinterpret_cast<std::uintptr_t>(element);
+    auto start = reinterpret_cast<std::uintptr_t>(buffer);
+    return buffer && address >= start && address < start + allocated * sizeof(Cell);
+}
+
+// Makes this (empty) array another owner of other's buffer.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::share(const myArray &other) noexcept
+{
+    other.owners->fetch_add(1, std::memory_order_relaxed);
+    buffer = other.buffer;
+    len = other.len;
+    allocated = other.allocated;
+    owners = other.owners;
+}
+
+// Drops this array's reference to its buffer, destroying the elements and freeing the buffer if it was the last
+// owner, and leaves the array empty with no buffer.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::release() noexcept
+{
+    if(!owners || owners->fetch_sub(1, std::memory_order_acq_rel) == 1)
     {
-        buffer[j] = Node<T>(inputArray[j]);
-        if (prev != nullptr)
+        for(size_t i = 0; i < len; ++i)
+            std::destroy_at(buffer + i);
+        if(buffer)
+            CellTraits::deallocate(cellAllocator, buffer, allocated);
+        if(owners)
         {
-            prev->set_next(*buffer[j]);
-            buffer[j].set_previous(prev);
+            CountAllocator countAllocator(cellAllocator);
+            std::destroy_at(owners);
+            std::allocator_traits<CountAllocator>::deallocate(countAllocator, owners, 1);
         }
-        prev = *buffer[j];
     }
-    first = *buffer[0];
-    last = *buffer[len - 1];
+    buffer = nullptr;
+    len = 0;
+    allocated = 0;
+    owners = nullptr;
 }
 
-template<typename T>
-myArray<T>::myArray(const myArray<T> &inputArray, size_t len2): buffer(nullptr),first(nullptr),last(nullptr),
-                                                                len(len2 == 0 ? inputArray.length() : len2)
+// Called before every modification: if the buffer is shared, copies the elements into a buffer of at least
+// `capacity` cells that only this array owns. A no-op for the other storage policies.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::detach(size_t capacity)
 {
-    initialMemory(2 * len);
-    Node<T> *previous = nullptr;
-    for(size_t j = 0; j < (len2 == 0 ? inputArray.length() : len2); ++j)
+    if constexpr (shared)
     {
-        buffer[j] = Node<T>(inputArray.at(j), previous);
-        if (previous != nullptr)
-            previous->set_next(*buffer[j]);
-        previous = &buffer[j];
+        if(!sharedBuffer())
+            return;
+        size_t alloc = std::max({capacity, allocated, size_t(1)});
+        Cell *newBuffer = CellTraits::allocate(cellAllocator, alloc);
+        std::atomic<size_t> *count;
+        try {
+            std::uninitialized_copy_n(buffer, len, newBuffer);
+            count = newCount();
+        } catch (...) {
+            std::destroy_n(newBuffer, len);
+            CellTraits::deallocate(cellAllocator, newBuffer, alloc);
+            throw;
+        }
+        size_t oldLen = len;
+        release();
+        buffer = newBuffer;
+        len = oldLen;
+        allocated = alloc;
+        owners = count;
     }
-    first = *buffer[0];
-    last = *buffer[len - 1];
 }
 
-template<typename T>
-myArray<T>::myArray(myArray &&inputArray): len(inputArray.length()),buffer(nullptr),first(nullptr),last(nullptr)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::relink(size_t from)
 {
-    initialMemory(2 * inputArray.length());
-    Node<T> *previous = nullptr;
-    for(size_t j = 0; j < inputArray.length(); ++j)
+    if constexpr (linked)
     {
-        buffer[j] = Node<T>(inputArray.at(j), previous);
-        if (previous != nullptr)
-            previous->set_next(*buffer[j]);
-        previous = &buffer[j];
+        for(size_t i = from; i < len; ++i)
+        {
+            buffer[i].set_previous(i > 0 ? *buffer[i - 1] : nullptr);
+            buffer[i].set_next(i + 1 < len ? *buffer[i + 1] : nullptr);
+        }
     }
-    first = *buffer[0];
-    last = *buffer[len - 1];
-    inputArray.clear(true);
 }
 
-template<typename T>
-myArray<T> &myArray<T>::operator=(const myArray &inputArray)
+// Moves the cell at `from` into the raw memory at `to`, leaving `from` as raw memory.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::relocate(size_t from, size_t to) noexcept
 {
+    ::new (static_cast<void*>(buffer + to)) Cell(std::move(buffer[from]));
+    std::destroy_at(buffer + from);
+}
+
+// Moves the cells [from, len) up by count, leaving [from, from + count) as raw memory. Capacity must already
+// hold len + count cells; len is left unchanged.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::shiftRight(size_t from, size_t count) noexcept
+{
+    if constexpr (std::is_trivially_copyable_v<Cell>)
+        std::memmove(static_cast<void*>(buffer + from + count), buffer + from, (len - from) * sizeof(Cell));
+    else
+        for(size_t i = len; i-- > from;)
+            relocate(i, i + count);
+}
+
+// Moves the cells [from + count, len) down onto the raw memory [from, from + count); len is left unchanged.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::shiftLeft(size_t from, size_t count) noexcept
+{
+    if constexpr (std::is_trivially_copyable_v<Cell>)
+        std::memmove(static_cast<void*>(buffer + from), buffer + from + count, (len - from - count) * sizeof(Cell));
+    else
+        for(size_t i = from + count; i < len; ++i)
+            relocate(i, i - count);
+}
+
+// Buffer cell holding the element at `index`: for GapStorage, elements at or after the gap are shifted by its width.
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::physical(size_t index) const
+{
+    if constexpr (gapped)
+        return index < len - tail ? index : index + (allocated - len);
+    else
+        return index;
+}
+
+// Moves the gap so that it starts right before the element at `pos`, relocating the elements in between.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::moveGap(size_t pos) noexcept
+{
+    if constexpr (gapped)
+    {
+        size_t gapStart = len - tail;
+        size_t gap = allocated - len;
+        if(gap > 0 && pos < gapStart)
+        {
+            if constexpr (std::is_trivially_copyable_v<Cell>)
+                std::memmove(static_cast<void*>(buffer + pos + gap), buffer + pos, (gapStart - pos) * sizeof(Cell));
+            else
+                for(size_t i = gapStart; i-- > pos;)
+                    relocate(i, i + gap);
+        }
+        else if(gap > 0 && pos > gapStart)
+        {
+            if constexpr (std::is_trivially_copyable_v<Cell>)
+                std::memmove(static_cast<void*>(buffer + gapStart), buffer + gapStart + gap, (pos - gapStart) * sizeof(Cell));
+            else
+                for(size_t i = gapStart; i < pos; ++i)
+                    relocate(i + gap, i);
+        }
+        tail = len - pos;
+    }
+}
+
+// Moves the gap to the end, after which the elements occupy buffer[0, len) like FlatStorage.
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::closeGap() noexcept
+{
+    moveGap(len);
+}
+
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::iterator myArray<T, Storage, Allocator>::begin()
+{
+    detach();
+    if constexpr (gapped)
+        return iterator(this, 0);
+    else
+        return iterator(buffer);
+}
+
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::iterator myArray<T, Storage, Allocator>::end()
+{
+    detach();
+    if constexpr (gapped)
+        return iterator(this, len);
+    else
+        return iterator(buffer + len);
+}
+
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::const_iterator myArray<T, Storage, Allocator>::begin() const
+{
+    if constexpr (gapped)
+        return const_iterator(this, 0);
+    else
+        return const_iterator(buffer);
+}
+
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::const_iterator myArray<T, Storage, Allocator>::end() const
+{
+    if constexpr (gapped)
+        return const_iterator(this, len);
+    else
+        return const_iterator(buffer + len);
+}
+
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::position(long long index) const
+{
+    if(index < 0)
+        index = len + index;
+    if(index < 0 || std::cmp_greater_equal(index, len))
+        throw std::out_of_range("Index is out of range.");
+    return index;
+}
+
+template<typename T, typename Storage, typename Allocator>
+T &myArray<T, Storage, Allocator>::value(size_t index)
+{
+    if constexpr (linked)
+        return buffer[index].get_data();
+    else
+        return buffer[physical(index)];
+}
+
+template<typename T, typename Storage, typename Allocator>
+const T &myArray<T, Storage, Allocator>::value(size_t index) const
+{
+    if constexpr (linked)
+        return buffer[index].get_data();
+    else
+        return buffer[physical(index)];
+}
+
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(): buffer(nullptr)
+{
+    initialMemory(defaultCapacity);
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(const Allocator &allocator): cellAllocator(allocator), buffer(nullptr)
+{
+    initialMemory(defaultCapacity);
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(T &initial): buffer(nullptr)
+{
+    initialMemory(defaultCapacity);
+    append(initial);
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(const T* inputArray, size_t len2, const Allocator &allocator):
+        cellAllocator(allocator), buffer(nullptr), len(len2)
+{
+    // twice the length leaves room to grow, unless the elements fit in SmallStorage's inline cells
+    initialMemory(len2 <= inlineCapacity ? inlineCapacity : 2 * len2);
+    for(size_t j = 0; j < len2; ++j)
+        construct(j, inputArray[j]);
+    relink();
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(const myArray<T, Storage, Allocator> &inputArray, size_t len2):
+        cellAllocator(CellTraits::select_on_container_copy_construction(inputArray.cellAllocator)), buffer(nullptr),
+                                                                len(len2 == 0 ? inputArray.length() : len2)
+{
+    if constexpr (shared)
+        if(inputArray.owners && len == inputArray.len && cellAllocator == inputArray.cellAllocator)
+        {
+            share(inputArray);
+            return;
+        }
+    initialMemory(len <= inlineCapacity ? inlineCapacity : 2 * len);
+    for(size_t j = 0; j < len; ++j)
+        construct(j, inputArray.at(j));
+    relink();
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::myArray(myArray &&inputArray) noexcept: cellAllocator(std::move(inputArray.cellAllocator)),
+                                                                        buffer(nullptr)
+{
+    steal(inputArray);
+}
+
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator> &myArray<T, Storage, Allocator>::operator=(const myArray &inputArray)
+{
+    if(this == &inputArray)
+        return *this;
+    if constexpr (shared)
+        if(inputArray.owners && cellAllocator == inputArray.cellAllocator)
+        {
+            if(owners != inputArray.owners)
+            {
+                release();
+                share(inputArray);
+            }
+            return *this;
+        }
+    clear(false);
     if(inputArray.length() > allocated)
-        extendMemory(inputArray.length() * 2);
+        grow(inputArray.length());
     for(size_t i = 0; i < inputArray.length(); ++i)
-        buffer[i] = inputArray.at(i);
+        construct(i, inputArray.at(i));
     len = inputArray.length();
-    first = *buffer[0];
-    last = *buffer[len - 1];
-    buffer[len - 1].set_next(nullptr);
+    relink();
+    return *this;
 }
 
-template<typename T>
-myArray<T> &myArray<T>::operator=(myArray &&inputArray) noexcept
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator> &myArray<T, Storage, Allocator>::operator=(myArray &&inputArray) noexcept(stealable)
 {
-    this->operator=(inputArray);
-    inputArray.clear();
+    if(this == &inputArray)
+        return *this;
+    if(stealable || cellAllocator == inputArray.cellAllocator)
+    {
+        if constexpr (shared)
+            release();
+        else
+        {
+            clear(false);
+            extendMemory(0);
+        }
+        if constexpr (CellTraits::propagate_on_container_move_assignment::value)
+            cellAllocator = std::move(inputArray.cellAllocator);
+        steal(inputArray);
+        return *this;
+    }
+    // the buffer belongs to a different memory resource, so only the elements can be moved over
+    inputArray.detach();
+    clear(false);
+    grow(inputArray.length());
+    for(size_t i = 0; i < inputArray.length(); ++i)
+        construct(i, std::move(inputArray.value(i)));
+    len = inputArray.length();
+    relink();
+    inputArray.clear(false);
     return *this;
 }
 
-template<typename T>
-Node<T> &myArray<T>::operator[](long long index) const
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::CellReference myArray<T, Storage, Allocator>::operator[](long long index) const
 {
-    if(index < 0)
-        index = len + index;
-    if(index >= len || index < 0)
-        throw std::out_of_range("Index is out of range.");
-    return buffer[index];
+    return buffer[physical(position(index))];
 }
 
-template<typename T>
-void myArray<T>::extendMemory(size_t newAlloc)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::extendMemory(size_t newAlloc)
 {
-    auto newBuffer = (Node<T> *) std::malloc(newAlloc * sizeof(Node<T>));
-    if (!newBuffer)
-        throw std::bad_alloc();
-    if(len > 0)
-        std::memcpy(newBuffer, buffer, newAlloc * sizeof(Node<T>));
-    std::free(buffer);
+    if constexpr (shared)
+        if(sharedBuffer())
+        {
+            // the elements have to be copied anyway, so copy them straight into a buffer of the new size
+            detach(newAlloc);
+            return;
+        }
+    closeGap();
+    if constexpr (small)
+    {
+        // the capacity never drops below the inline cells, and a buffer that fits in them goes back inline
+        newAlloc = std::max(newAlloc, inlineCapacity);
+        if(newAlloc == inlineCapacity && buffer == localCells())
+            return;
+    }
+    if(newAlloc == 0)
+    {
+        deallocateCells(buffer, allocated);
+        buffer = nullptr;
+        allocated = 0;
+        return;
+    }
+    Cell *newBuffer;
+    if constexpr (reallocatable)
+        newBuffer = buffer ? cellAllocator.reallocate(buffer, allocated, newAlloc)
+                           : CellTraits::allocate(cellAllocator, newAlloc);
+    else
+    {
+        newBuffer = allocateCells(newAlloc);
+        for(size_t i = 0; i < len; ++i)
+        {
+            ::new (static_cast<void*>(newBuffer + i)) Cell(std::move(value(i)));
+            std::destroy_at(buffer + i);
+        }
+        deallocateCells(buffer, allocated);
+    }
     buffer = newBuffer;
     allocated = newAlloc;
+    if constexpr (shared)
+        if(!owners)
+            owners = newCount();
+    relink();
 }
 
-template<typename T>
-T myArray<T>::pop(long long index)
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::Cell *myArray<T, Storage, Allocator>::localCells()
+{
+    if constexpr (small)
+        return reinterpret_cast<Cell *>(local.bytes);
+    else
+        return nullptr;
+}
+
+// Buffer for `count` cells: the inline cells of SmallStorage when they are big enough, otherwise the allocator's.
+template<typename T, typename Storage, typename Allocator>
+typename myArray<T, Storage, Allocator>::Cell *myArray<T, Storage, Allocator>::allocateCells(size_t count)
+{
+    if constexpr (small)
+        if(count <= inlineCapacity)
+            return localCells();
+    return CellTraits::allocate(cellAllocator, count);
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::deallocateCells(Cell *cells, size_t count) noexcept
+{
+    if constexpr (small)
+        if(cells == localCells())
+            return;
+    if(cells)
+        CellTraits::deallocate(cellAllocator, cells, count);
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::grow(size_t needed)
+{
+    if(needed <= allocated)
+        return;
+    auto scaled = static_cast<size_t>(static_cast<double>(allocated) * growth);
+    extendMemory(std::max(needed, scaled));
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::setGrowthFactor(double factor)
+{
+    if(!(factor > 1.0))
+        throw std::invalid_argument("Growth factor must be greater than 1.");
+    growth = factor;
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::reserve(size_t capacity)
+{
+    if(capacity > allocated)
+        extendMemory(capacity);
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::shrink_to_fit()
+{
+    if(allocated > len)
+        extendMemory(len);
+}
+
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::pop(long long index)
 {
     if(len == 0)
         throw std::out_of_range("Pop from an empty list.\n");
+    if(auto output = try_pop(index))
+        return std::move(*output);
+    throw std::out_of_range("Index is out of range.\n");
+}
+
+// pop() for callers that expect misses: nullopt for an empty array or an index out of range, without throwing.
+template<typename T, typename Storage, typename Allocator>
+std::optional<T> myArray<T, Storage, Allocator>::try_pop(long long index)
+{
     if(index < 0)
         index = len + index;
-    if(index >= len || index < 0)
-        throw std::out_of_range("Index is out of range.\n");
-    auto output = at(index);
-    if(index < len - 1)
-    {
-        do {
-            buffer[index] = buffer[index + 1];
-        } while(index++ < len - 2);
-    }
-    last = last->get_previous();
-    last->set_next(nullptr);
-    buffer[len-- - 1].set_previous(nullptr);
+    if(index < 0 || std::cmp_greater_equal(index, len))
+        return std::nullopt;
+    detach();
+    std::optional<T> output(std::move(value(index)));
+    erase(index, 1);
     return output;
 }
 
-template<typename T>
-size_t myArray<T>::index(const T &element, size_t from) const
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::index(const T &element, size_t from) const
 {
-    for(size_t j = from; j < len; ++j)
-        if(buffer[j] == element)
-            return j;
+    if(auto found = try_index(element, from))
+        return *found;
     throw std::out_of_range("Object is not in list.\n");
 }
 
-template<typename T>
-bool myArray<T>::in(const T &element) const
+template<typename T, typename Storage, typename Allocator>
+std::optional<size_t> myArray<T, Storage, Allocator>::try_index(const T &element, size_t from) const
 {
-    auto iter = first;
-    while(iter != nullptr)
+    if constexpr (vectorSearch)
     {
-        if(element == iter->get_data())
-            return true;
-        iter = iter->get_next();
+        if(from < len)
+            if(size_t found = from + arraySimd::find(buffer + from, len - from, element); found < len)
+                return found;
+    }
+    else
+    {
+        for(size_t j = from; j < len; ++j)
+            if(value(j) == element)
+                return j;
     }
+    return std::nullopt;
+}
+
+template<typename T, typename Storage, typename Allocator>
+bool myArray<T, Storage, Allocator>::in(const T &element) const
+{
+    if constexpr (vectorSearch)
+        return arraySimd::find(buffer, len, element) < len;
+    for(size_t j = 0; j < len; ++j)
+        if(element == value(j))
+            return true;
     return false;
 }
 
-template<typename T>
-size_t myArray<T>::count(const T &element) const
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::count(const T &element) const
 {
-    long output(0);
+    if constexpr (vectorSearch)
+        return arraySimd::count(buffer, len, element);
+    size_t output(0);
     for(size_t j = 0; j < len; ++j)
-        if(buffer[j] == element)
+        if(value(j) == element)
             ++output;
     return output;
 }
 
-template<typename T>
-void myArray<T>::append(const T &element)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::append(const T &element)
 {
+    emplace_back(element);
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::append(T &&element)
+{
+    emplace_back(std::move(element));
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename... Args>
+T &myArray<T, Storage, Allocator>::emplace_back(Args &&...args)
+{
+    detach();
+    closeGap();
     if(len == allocated)
-        extendMemory((allocated + 1) * 2);
-    buffer[len] = Node<T>(element, len > 0 ? *buffer[len - 1] : nullptr);
-    buffer[len - 1].set_next(*buffer[len]);
+    {
+        // the arguments may refer into the buffer, so build the element before it moves
+        T element(std::forward<Args>(args)...);
+        grow(len + 1);
+        construct(len, std::move(element));
+    }
+    else
+        construct(len, std::forward<Args>(args)...);
     len += 1;
-    last = *buffer[len - 1];
-    if(first == nullptr) first = last;
+    relink(len > 1 ? len - 2 : 0);
+    return value(len - 1);
 }
 
-template<typename T>
-void myArray<T>::reverse()
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::reverse()
 {
-    long border = len / 2;
+    detach();
+    size_t border = len / 2;
     for(size_t i = 0; i < border; ++i)
-    {
-        auto temp = buffer[len - i - 1];
-        buffer[len - i - 1] = buffer[i];
-        buffer[i] = temp;
-    }
+        std::swap(value(i), value(len - i - 1));
 }
 
-template<typename T>
-void myArray<T>::extend(const myArray<T> &second)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::extend(const myArray<T, Storage, Allocator> &second)
 {
     size_t leng = second.length();
-    if(len + leng > allocated)
-        extendMemory((len + leng) * 2);
+    grow(len + leng);
     for(size_t i = 0; i < leng; ++i)
         append(second.at(i));
 }
 
-template<typename T>
-void myArray<T>::clear(bool shrink)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::clear(bool shrink)
 {
+    if constexpr (shared)
+        if(sharedBuffer())
+        {
+            // the other owners keep the elements; this array just lets go of them and is left without a buffer
+            release();
+            return;
+        }
     for(size_t i = 0; i < len; ++i)
-        buffer[i].~Node();
+        std::destroy_at(buffer + physical(i));
     len = 0;
+    if constexpr (gapped)
+        tail = 0;
     if(shrink)
-        extendMemory(10);
+        shrink_to_fit();
 }
 
-template<typename T>
-myArray<T>::~myArray()
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator>::~myArray()
 {
-    clear(false);
-    std::free(buffer);
+    if constexpr (shared)
+        release();
+    else
+    {
+        clear(false);
+        deallocateCells(buffer, allocated);
+    }
 }
 
-template<typename T>
-myArray<T> myArray<T>::copy() const
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator> myArray<T, Storage, Allocator>::copy() const
 {
-    myArray<T> output;
+    if constexpr (shared)
+        return myArray(*this);
+    myArray<T, Storage, Allocator> output(get_allocator());
     for(size_t i = 0; i < len; i += 1)
         output.append(at(i));
     return output;
 }
 
-template<typename T>
-void myArray<T>::insertionSort(bool reverse)
+template<typename T, typename Storage, typename Allocator>
+template<typename Sorter>
+void myArray<T, Storage, Allocator>::sortValues(Sorter sorter)
 {
     if(len < 2) return;
-    for(size_t i = 1; i < len; ++i)
+    detach();
+    if constexpr (linked)
     {
-        T key = buffer[i].get_data();
-        size_t j = i - 1;
-        while(reverse ? buffer[j] < key : buffer[j] > key)
-        {
-            buffer[j + 1] = buffer[j];
-            if(j == 0)
-                break;
-            j -= 1;
-        }
-        buffer[j == 0 ? 0 : j + 1] = key;
+        // nodes are not contiguous, so the values are sorted in a scratch buffer and moved back
+        std::vector<T> values;
+        values.reserve(len);
+        for(size_t i = 0; i < len; ++i)
+            values.push_back(std::move(value(i)));
+        sorter(values.data(), len);
+        for(size_t i = 0; i < len; ++i)
+            value(i) = std::move(values[i]);
+    }
+    else
+    {
+        closeGap();
+        sorter(buffer, len);
     }
 }
 
-template<typename T>
-void myArray<T>::sort(bool reverse)
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::sort(bool reverse)
 {
-    insertionSort(reverse);
+    sortValues([&](T *data, size_t n) { arraySort::naturalSort(data, n, reverse, false); });
 }
 
-template<typename T>
-std::string myArray<T>::str(std::string del) const
+template<typename T, typename Storage, typename Allocator>
+template<typename Compare> requires std::predicate<Compare &, const T &, const T &>
+void myArray<T, Storage, Allocator>::sort(Compare comp)
+{
+    sortValues([&](T *data, size_t n) { arraySort::sort(data, n, std::ref(comp)); });
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Compare, typename Projection> requires std::invocable<Projection &, const T &>
+void myArray<T, Storage, Allocator>::sort(Compare comp, Projection proj)
+{
+    auto projected = [&](const T &a, const T &b) {
+        return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+    };
+    sortValues([&](T *data, size_t n) { arraySort::sort(data, n, projected); });
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::stable_sort(bool reverse)
+{
+    sortValues([&](T *data, size_t n) { arraySort::naturalSort(data, n, reverse, true); });
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Compare> requires std::predicate<Compare &, const T &, const T &>
+void myArray<T, Storage, Allocator>::stable_sort(Compare comp)
+{
+    sortValues([&](T *data, size_t n) { arraySort::stableSort(data, n, std::ref(comp)); });
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Compare, typename Projection> requires std::invocable<Projection &, const T &>
+void myArray<T, Storage, Allocator>::stable_sort(Compare comp, Projection proj)
+{
+    auto projected = [&](const T &a, const T &b) {
+        return std::invoke(comp, std::invoke(proj, a), std::invoke(proj, b));
+    };
+    sortValues([&](T *data, size_t n) { arraySort::stableSort(data, n, projected); });
+}
+
+template<typename T, typename Storage, typename Allocator>
+std::string myArray<T, Storage, Allocator>::str(std::string del) const
 {
     std::ostringstream output;
     for(size_t i = 0; i < len; ++i)
@@ -425,120 +1382,247 @@ std::string myArray<T>::str(std::string del) const
     return output.str();
 }
 
-template<typename T>
-void myArray<T>::vectorise(T (*func) (T))
+template<typename T, typename Storage, typename Allocator>
+template<typename Policy>
+unsigned myArray<T, Storage, Allocator>::policyChunks() const
 {
-    if(first == nullptr) return;
-    for(size_t i = 0; i < len; ++i)
-        buffer[i] = func(buffer[i].get_data());
+    if constexpr (arrayParallel::runsInParallel<Policy>)
+        return arrayParallel::chunksFor(len);
+    else
+        return 1;
 }
 
-template<typename T>
-bool myArray<T>::isSubarray(myArray<T> &other) const
+template<typename T, typename Storage, typename Allocator>
+template<typename F> requires std::invocable<F &, T &>
+void myArray<T, Storage, Allocator>::vectorise(F func)
+{
+    vectorise(arrayParallel::seq, std::move(func));
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename Policy, typename F>
+        requires arrayParallel::executionPolicy<Policy> && std::invocable<F &, T &>
+void myArray<T, Storage, Allocator>::vectorise(Policy &&, F func)
 {
+    detach();
+    arrayParallel::forChunks(len, policyChunks<Policy>(), [&](size_t begin, size_t end, unsigned) {
+        for(size_t i = begin; i < end; ++i)
+            value(i) = std::invoke(func, value(i));
+    });
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename U, typename F> requires std::invocable<F &, const T &>
+auto myArray<T, Storage, Allocator>::map(F func) const -> rebind<mapped<U, F>>
+{
+    return map<U>(arrayParallel::seq, std::move(func));
+}
+
+template<typename T, typename Storage, typename Allocator>
+template<typename U, typename Policy, typename F>
+        requires arrayParallel::executionPolicy<Policy> && std::invocable<F &, const T &>
+auto myArray<T, Storage, Allocator>::map(Policy &&, F func) const -> rebind<mapped<U, F>>
+{
+    using Output = rebind<mapped<U, F>>;
+    Output output{typename Output::allocator_type(get_allocator())};
+    output.reserve(len);
+    // every chunk constructs its own slice of the output; on failure the slices built so far are destroyed
+    unsigned chunks = policyChunks<Policy>();
+    std::vector<std::pair<size_t, size_t>> built(chunks);
     try {
-        subarrayIndex(other);
-        return true;
-    } catch (std::out_of_range &e) {
-        return false;
+        arrayParallel::forChunks(len, chunks, [&](size_t begin, size_t end, unsigned chunk) {
+            built[chunk] = {begin, begin};
+            for(size_t &i = built[chunk].second; i < end; ++i)
+                output.construct(i, std::invoke(func, value(i)));
+        });
+    } catch (...) {
+        for(auto &[begin, end]: built)
+            for(size_t i = begin; i < end; ++i)
+                std::destroy_at(output.buffer + i);
+        throw;
     }
+    output.len = len;
+    output.relink();
+    return output;
 }
 
-template<typename T>
-size_t myArray<T>::subarrayIndex(myArray<T> &other, size_t from) const
-{
-    size_t m = other.length();
-    auto lps = new size_t[m+1];
-    size_t j = 0;
-    size_t i = 1;
-    while (i < m) {
-        if (other.at(i) == other.at(j)) {
-            j++;
-            lps[i] = j;
-            i++;
-        }
-        else {
-            if (j != 0)
-                j = lps[j-1];
-            else
-                lps[i++] = 0;
-        }
-    }
-    i = from;
-    j = 0;
-    while (i < len) {
-        if (this->at(i) == other.at(j)) {
-            i++;
-            j++;
-            if (j == m) {
-                delete [] lps;
-                return i - j;
-            }
-        }
-        else {
-            if (j == 0)
-                i++;
-            else
-                j = lps[j-1];
-        }
-    }
-    delete [] lps;
+template<typename T, typename Storage, typename Allocator>
+template<typename S, typename A>
+bool myArray<T, Storage, Allocator>::isSubarray(const myArray<T, S, A> &other) const
+{
+    return isSubarray(Pattern<T>(other));
+}
+
+template<typename T, typename Storage, typename Allocator>
+bool myArray<T, Storage, Allocator>::isSubarray(const Pattern<T> &pattern) const
+{
+    return find(pattern).has_value();
+}
+
+// Compiles `other` for this one search; callers that look for the same subarray repeatedly should build a
+// Pattern once and use the overload below.
+template<typename T, typename Storage, typename Allocator>
+template<typename S, typename A>
+size_t myArray<T, Storage, Allocator>::subarrayIndex(const myArray<T, S, A> &other, size_t from) const
+{
+    return subarrayIndex(Pattern<T>(other), from);
+}
+
+template<typename T, typename Storage, typename Allocator>
+size_t myArray<T, Storage, Allocator>::subarrayIndex(const Pattern<T> &pattern, size_t from) const
+{
+    if(auto found = find(pattern, from))
+        return *found;
     throw std::out_of_range("Not a subarray");
 }
 
-template<typename T>
-void myArray<T>::remove(T element)
+template<typename T, typename Storage, typename Allocator>
+template<typename S, typename A>
+std::optional<size_t> myArray<T, Storage, Allocator>::find(const myArray<T, S, A> &other, size_t from) const
 {
-    try {
-        auto ind = index(element);
-        pop(ind);
-    } catch (std::out_of_range &e) {
-        return;
+    return find(Pattern<T>(other), from);
+}
+
+// Non-throwing subarrayIndex: the position of the first occurrence at or after `from`, or nullopt.
+template<typename T, typename Storage, typename Allocator>
+std::optional<size_t> myArray<T, Storage, Allocator>::find(const Pattern<T> &pattern, size_t from) const
+{
+    if(size_t found = pattern.find(begin(), end(), from); found < len)
+        return found;
+    return std::nullopt;
+}
+
+// Writes the position of every occurrence, overlapping ones included, to `out` and returns the advanced iterator.
+template<typename T, typename Storage, typename Allocator>
+template<std::output_iterator<size_t> Out>
+Out myArray<T, Storage, Allocator>::findAll(const Pattern<T> &pattern, Out out) const
+{
+    pattern.forEachMatch(begin(), end(), [&](size_t position) { *out++ = position; });
+    return out;
+}
+
+#if __cpp_lib_generator
+// Lazily yields the position of every occurrence; the array and the pattern must outlive the generator.
+template<typename T, typename Storage, typename Allocator>
+std::generator<size_t> myArray<T, Storage, Allocator>::findAll(const Pattern<T> &pattern) const
+{
+    for(size_t found = pattern.find(begin(), end()); found < len; found = pattern.find(begin(), end(), found + 1))
+        co_yield found;
+}
+#endif
+
+// Every occurrence of every pattern of the set, ordered by where it ends, found in one pass over the array.
+template<typename T, typename Storage, typename Allocator>
+std::vector<typename PatternSet<T>::Match> myArray<T, Storage, Allocator>::matches(const PatternSet<T> &patterns) const
+{
+    return patterns.findAll(begin(), end());
+}
+
+template<typename T, typename Storage, typename Allocator>
+void myArray<T, Storage, Allocator>::remove(T element)
+{
+    if(auto found = try_index(element))
+        erase(*found);
+}
+
+
+template<typename T, typename Storage, typename Allocator>
+std::pair<T, T> myArray<T, Storage, Allocator>::minmax() const
+{
+    if(auto result = try_minmax())
+        return *result;
+    throw std::out_of_range("Empty list.");
+}
+
+template<typename T, typename Storage, typename Allocator>
+std::optional<std::pair<T, T>> myArray<T, Storage, Allocator>::try_minmax() const
+{
+    if(len == 0)
+        return std::nullopt;
+    if constexpr (contiguous && arraySimd::reducible<T>)
+    {
+        std::vector<std::pair<T, T>> partial(arrayParallel::chunksFor(len));
+        arrayParallel::forChunks(len, partial.size(), [&](size_t begin, size_t end, unsigned chunk) {
+            partial[chunk] = arraySimd::minmax(buffer + begin, end - begin);
+        });
+        // a chunk of nothing but NaN reports NaN, which widen() skips like a NaN element
+        std::pair<T, T> result = partial[0];
+        for(auto &[smallest, largest]: partial)
+        {
+            arraySimd::widen(result, smallest);
+            arraySimd::widen(result, largest);
+        }
+        return result;
     }
+    std::pair<T, T> result{value(0), value(0)};
+    for(size_t i = 1; i < len; ++i)
+        arraySimd::widen(result, value(i));
+    return result;
 }
 
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::min() const
+{
+    if(auto result = try_min())
+        return *result;
+    throw std::out_of_range("Empty list.");
+}
 
-template<typename T>
-T myArray<T>::min() const
+template<typename T, typename Storage, typename Allocator>
+T myArray<T, Storage, Allocator>::max() const
 {
-    auto iter = first;
-    T mx;
-    if (len == 0) throw std::out_of_range("Empty list.");
-    while(iter != nullptr)
+    if(auto result = try_max())
+        return *result;
+    throw std::out_of_range("Empty list.");
+}
+
+template<typename T, typename Storage, typename Allocator>
+std::optional<T> myArray<T, Storage, Allocator>::try_min() const
+{
+    if constexpr (contiguous && arraySimd::reducible<T>)
     {
-        if(iter->get_data() < mx)
-            mx = iter->get_data();
-        iter = iter->get_next();
+        if(auto result = try_minmax())
+            return result->first;
+        return std::nullopt;
     }
+    if(len == 0)
+        return std::nullopt;
+    T mx = value(0);
+    for(size_t i = 1; i < len; ++i)
+        if(value(i) < mx || arraySimd::isNan(mx))
+            mx = value(i);
     return mx;
 }
 
-template<typename T>
-T myArray<T>::max() const
+template<typename T, typename Storage, typename Allocator>
+std::optional<T> myArray<T, Storage, Allocator>::try_max() const
 {
-    auto iter = first;
-    if (len == 0) throw std::out_of_range("Empty list.");
-    T mx;
-    while(iter != nullptr)
+    if constexpr (contiguous && arraySimd::reducible<T>)
     {
-        if(iter->get_data() > mx)
-            mx = iter->get_data();
-        iter = iter->get_next();
+        if(auto result = try_minmax())
+            return result->second;
+        return std::nullopt;
     }
+    if(len == 0)
+        return std::nullopt;
+    T mx = value(0);
+    for(size_t i = 1; i < len; ++i)
+        if(value(i) > mx || arraySimd::isNan(mx))
+            mx = value(i);
     return mx;
 }
 
 
-template<typename T>
-myArray<T> myArray<T>::operator+(myArray<T> &other)
+template<typename T, typename Storage, typename Allocator>
+myArray<T, Storage, Allocator> myArray<T, Storage, Allocator>::operator+(myArray<T, Storage, Allocator> &other)
 {
-    myArray<T> newArr = copy();
+    myArray<T, Storage, Allocator> newArr = copy();
     newArr.extend(other);
     return newArr;
 }
 
-template<typename T>
-std::ostringstream &myArray<T>::operator<<(std::ostringstream &in)
+template<typename T, typename Storage, typename Allocator>
+std::ostringstream &myArray<T, Storage, Allocator>::operator<<(std::ostringstream &in)
 {
     in << str();
     return in;
@@ -0,0 +1,21 @@
+#pragma once
+#include "myArray_parallel.h"
+#include <execution>
+
+// Opt-in support for passing the std::execution policies to the myArray family, e.g.
+// array.vectorise(std::execution::par, f). They behave like their arrayParallel counterparts. The array headers
+// do not include <execution> themselves: with libstdc++ it makes every program that includes it link TBB
+// whenever TBB's headers are installed.
+namespace arrayParallel
+{
+    template <>
+    struct policyTraits<std::execution::sequenced_policy> { static constexpr bool parallel = false; };
+    template <>
+    struct policyTraits<std::execution::parallel_policy> { static constexpr bool parallel = true; };
+    template <>
+    struct policyTraits<std::execution::parallel_unsequenced_policy> { static constexpr bool parallel = true; };
+#if __cpp_lib_execution >= 201902L
+    template <>
+    struct policyTraits<std::execution::unsequenced_policy> { static constexpr bool parallel = false; };
+#endif
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include "myArray_class.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Index of every window of `k` consecutive elements of an array by its Rabin-Karp fingerprint (a polynomial hash
+// modulo the Mersenne prime 2^61 - 1), for programs that ask where many different patterns of the same length
+// occur in one array. Building it is a single O(n) pass; afterwards a query costs O(k) to fingerprint the pattern
+// plus one hash lookup, and every candidate is compared element by element, so collisions never give wrong answers.
+// The index follows the array through appends: append() through the index updates both, and sync() picks up
+// elements appended to the array directly, in O(1) per element. Any other modification of the array needs a
+// rebuild(). Array is any container with length(), append() and a const operator()(size_t), e.g. myArray or myRope.
+template <typename Array>
+class FingerprintIndex
+{
+public:
+    using value_type = typename Array::value_type;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    FingerprintIndex(Array &array, size_t k);
+    size_t window() const { return k; };
+    size_t windows() const { return indexed >= k ? indexed - k + 1 : 0; };
+    void append(const value_type &element);
+    void sync();
+    void rebuild();
+    template <std::ranges::forward_range Range>
+    std::optional<size_t> find(const Range &pattern, size_t from = 0) const;
+    template <std::ranges::forward_range Range, typename F>
+    void forEachMatch(const Range &pattern, F f) const;
+    template <std::ranges::forward_range Range>
+    size_t count(const Range &pattern) const;
+private:
+    static constexpr uint64_t prime = (uint64_t(1) << 61) - 1;
+    static constexpr uint64_t base = arrayHash::secret[0] % prime;
+    Array *array;
+    size_t k;
+    // base^(k - 1), the weight of the element that leaves the window
+    uint64_t power = 1;
+    // fingerprint of the last min(k, indexed) elements
+    uint64_t rolling = 0;
+    size_t indexed = 0;
+    // windows with the same fingerprint form a chain in increasing order: first and last start of each chain,
+    // and next[start] the following start (npos at the end)
+    std::unordered_map<uint64_t, std::pair<size_t, size_t>> chains;
+    std::vector<size_t> next;
+    static uint64_t multiply(uint64_t a, uint64_t b);
+    static uint64_t reduce(uint64_t value) { return value >= prime ? value - prime : value; };
+    static uint64_t digit(const value_type &element);
+    template <std::ranges::forward_range Range>
+    uint64_t fingerprint(const Range &pattern) const;
+};
+
+
+template <typename Array>
+FingerprintIndex<Array>::FingerprintIndex(Array &array, size_t k) : array(&array), k(k)
+{
+    if(k == 0)
+        throw std::invalid_argument("Window length must be positive.");
+    for(size_t i = 1; i < k; ++i)
+        power = multiply(power, base);
+    sync();
+}
+
+template <typename Array>
+uint64_t FingerprintIndex<Array>::multiply(uint64_t a, uint64_t b)
+{
+    // a * b < 2^122; folding the high bits back in uses 2^61 = 1 (mod prime)
+    arrayHash::multiply(a, b);
+    return reduce(reduce((a & prime) + (a >> 61) + (b << 3)));
+}
+
+template <typename Array>
+uint64_t FingerprintIndex<Array>::digit(const value_type &element)
+{
+    uint64_t value = std::hash<value_type>{}(element);
+    return reduce((value & prime) + (value >> 61));
+}
+
+template <typename Array>
+template <std::ranges::forward_range Range>
+uint64_t FingerprintIndex<Array>::fingerprint(const Range &pattern) const
+{
+    uint64_t output = 0;
+    size_t length = 0;
+    for(const auto &element: pattern)
+    {
+        output = reduce(multiply(output, base) + digit(element));
+        ++length;
+    }
+    if(length != k)
+        throw std::invalid_argument("Pattern length differs from the index window.");
+    return output;
+}
+
+template <typename Array>
+void FingerprintIndex<Array>::append(const value_type &element)
+{
+    array->append(element);
+    sync();
+}
+
+// Indexes the windows ending in elements appended since the last call, or rebuilds if the array got shorter.
+template <typename Array>
+void FingerprintIndex<Array>::sync()
+{
+    const Array &source = *array;
+    if(source.length() < indexed)
+    {
+        rebuild();
+        return;
+    }
+    if(source.length() + 1 > k)
+        next.reserve(source.length() + 1 - k);
+    for(; indexed < source.length(); ++indexed)
+    {
+        if(indexed >= k)
+            rolling = reduce(rolling + prime - multiply(digit(source(indexed - k)), power));
+        rolling = reduce(multiply(rolling, base) + digit(source(indexed)));
+        if(indexed + 1 < k)
+            continue;
+        size_t start = indexed + 1 - k;
+        next.push_back(npos);
+        auto [chain, added] = chains.try_emplace(rolling, start, start);
+        if(!added)
+        {
+            next[chain->second.second] = start;
+            chain->second.second = start;
+        }
+    }
+}
+
+template <typename Array>
+void FingerprintIndex<Array>::rebuild()
+{
+    chains.clear();
+    next.clear();
+    rolling = 0;
+    indexed = 0;
+    sync();
+}
+
+// Calls f(position) for every window equal to `pattern`, in increasing order; returning false from f stops.
+// Throws std::invalid_argument if the pattern is not window() elements long.
+template <typename Array>
+template <std::ranges::forward_range Range, typename F>
+void FingerprintIndex<Array>::forEachMatch(const Range &pattern, F f) const
+{
+    auto chain = chains.find(fingerprint(pattern));
+    if(chain == chains.end())
+        return;
+    const Array &source = *array;
+    for(size_t start = chain->second.first; start != npos; start = next[start])
+    {
+        size_t i = start;
+        bool equal = true;
+        for(const auto &element: pattern)
+            if(!(source(i++) == element))
+            {
+                equal = false;
+                break;
+            }
+        if(equal && !arrayPattern::report(f, start))
+            return;
+    }
+}
+
+template <typename Array>
+template <std::ranges::forward_range Range>
+std::optional<size_t> FingerprintIndex<Array>::find(const Range &pattern, size_t from) const
+{
+    std::optional<size_t> found;
+    forEachMatch(pattern, [&](size_t start) {
+        if(start < from)
+            return true;
+        found = start;
+        return false;
+    });
+    return found;
+}
+
+template <typename Array>
+template <std::ranges::forward_range Range>
+size_t FingerprintIndex<Array>::count(const Range &pattern) const
+{
+    size_t output = 0;
+    forEachMatch(pattern, [&](size_t) { ++output; });
+    return output;
+}
@@ -0,0 +1,239 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+// Hashing behind myArray::hash(). Arrays whose elements are plain bytes in memory are hashed as one block with a
+// wyhash-style function (64x64->128 bit multiply-and-fold over 16 or 48 bytes per step), which runs at close to
+// memory bandwidth; every other array combines the std::hash of its elements.
+namespace arrayHash
+{
+    inline constexpr uint64_t secret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                                           0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+    // Full 128 bit product of a and b, low half in a and high half in b.
+    inline void multiply(uint64_t &a, uint64_t &b)
+    {
+#ifdef __SIZEOF_INT128__
+        __uint128_t product = static_cast<__uint128_t>(a) * b;
+        a = static_cast<uint64_t>(product);
+        b = static_cast<uint64_t>(product >> 64);
+#else
+        uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a), bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+        uint64_t high = aHigh * bHigh, middle0 = aHigh * bLow, middle1 = aLow * bHigh, low = aLow * bLow;
+        uint64_t t = low + (middle0 << 32);
+        uint64_t carry = t < low;
+        uint64_t lowHalf = t + (middle1 << 32);
+        carry += lowHalf < t;
+        a = lowHalf;
+        b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+    }
+
+    inline uint64_t mix(uint64_t a, uint64_t b)
+    {
+        multiply(a, b);
+        return a ^ b;
+    }
+
+    inline uint64_t read8(const unsigned char *p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, 8);
+        return value;
+    }
+
+    inline uint64_t read4(const unsigned char *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, 4);
+        return value;
+    }
+
+    inline uint64_t bytes(const void *data, size_t n, uint64_t seed = 0)
+    {
+        auto p = static_cast<const unsigned char *>(data);
+        seed ^= mix(seed ^ secret[0], secret[1]);
+        uint64_t a, b;
+        if(n <= 16)
+        {
+            if(n >= 4)
+            {
+                // two overlapping 4 byte reads from each end cover every length from 4 to 16
+                size_t step = (n >> 3) << 2;
+                a = (read4(p) << 32) | read4(p + step);
+                b = (read4(p + n - 4) << 32) | read4(p + n - 4 - step);
+            }
+            else if(n > 0)
+            {
+                a = (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+                b = 0;
+            }
+            else
+                a = b = 0;
+        }
+        else
+        {
+            size_t i = n;
+            if(i > 48)
+            {
+                // three independent lanes keep the multipliers busy
+                uint64_t lane1 = seed, lane2 = seed;
+                do
+                {
+                    seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+                    lane1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ lane1);
+                    lane2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ lane2);
+                    p += 48;
+                    i -= 48;
+                } while(i > 48);
+                seed ^= lane1 ^ lane2;
+            }
+            while(i > 16)
+            {
+                seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+                p += 16;
+                i -= 16;
+            }
+            a = read8(p + i - 16);
+            b = read8(p + i - 8);
+        }
+        a ^= secret[1];
+        b ^= seed;
+        multiply(a, b);
+        return mix(a ^ secret[0] ^ n, b ^ secret[1]);
+    }
+
+    // Running hash of a sequence of element hashes; finish() folds in the length.
+    struct combiner
+    {
+        uint64_t state = secret[0];
+        void add(size_t element) { state = mix(state ^ element, secret[1]); }
+        uint64_t finish(size_t n) const { return mix(state ^ secret[2], n ^ secret[3]); }
+    };
+
+    template <typename T>
+    concept hashable = requires (const T &value) { { std::hash<T>{}(value) } -> std::convertible_to<size_t>; };
+}
+
+
+// Array that remembers its hash, for arrays hashed again and again while rarely changing (e.g. keys of a map).
+// Caching is opt-in through this wrapper so that plain arrays carry no extra state and their element access
+// stays a bare load or store. Elements can only be read through the wrapper; the structural mutators below
+// forget the cached hash, and any other change goes through modify(), which forgets it afterwards. Array is any
+// container with a hash() member, e.g. myArray.
+template <typename Array>
+class HashedArray
+{
+public:
+    using value_type = typename Array::value_type;
+    HashedArray() = default;
+    HashedArray(const Array &array) : array(array) {};
+    HashedArray(Array &&array) : array(std::move(array)) {};
+    HashedArray(const HashedArray &other) : array(other.array),
+                                            cached(other.cached.load(std::memory_order_relaxed)) {};
+    HashedArray(HashedArray &&other) noexcept : array(std::move(other.array)),
+                                                cached(other.cached.exchange(0, std::memory_order_relaxed)) {};
+    HashedArray &operator=(const HashedArray &other);
+    HashedArray &operator=(HashedArray &&other) noexcept;
+    const Array &get() const { return array; };
+    operator const Array &() const { return array; };
+    size_t length() const { return array.length(); };
+    auto begin() const { return array.begin(); };
+    auto end() const { return array.end(); };
+    decltype(auto) operator()(size_t index) const { return array(index); };
+    decltype(auto) at(long long index) const { return array.at(index); };
+    size_t hash() const;
+    bool hashCached() const { return cached.load(std::memory_order_relaxed) != 0; };
+    bool operator==(const HashedArray &other) const;
+    template <typename... Args>
+    void append(Args &&...args) { array.append(std::forward<Args>(args)...); forget(); };
+    template <typename... Args>
+    void insert(Args &&...args) { array.insert(std::forward<Args>(args)...); forget(); };
+    template <typename... Args>
+    void erase(Args &&...args) { array.erase(std::forward<Args>(args)...); forget(); };
+    template <typename... Args>
+    auto pop(Args &&...args);
+    void clear() { array.clear(); forget(); };
+    template <typename F> requires std::invocable<F &, Array &>
+    decltype(auto) modify(F f);
+private:
+    Array array;
+    // 0 while nothing is cached; a hash of 0 is simply never kept. Atomic so that concurrent const calls may
+    // fill it in.
+    mutable std::atomic<size_t> cached{0};
+    void forget() { cached.store(0, std::memory_order_relaxed); };
+};
+
+
+template <typename Array>
+HashedArray<Array> &HashedArray<Array>::operator=(const HashedArray &other)
+{
+    array = other.array;
+    cached.store(other.cached.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+template <typename Array>
+HashedArray<Array> &HashedArray<Array>::operator=(HashedArray &&other) noexcept
+{
+    array = std::move(other.array);
+    cached.store(other.cached.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+// Same value as the wrapped array's hash(), computed at most once between modifications.
+template <typename Array>
+size_t HashedArray<Array>::hash() const
+{
+    size_t output = cached.load(std::memory_order_relaxed);
+    if(output == 0)
+    {
+        output = array.hash();
+        cached.store(output, std::memory_order_relaxed);
+    }
+    return output;
+}
+
+// Two cached hashes that differ settle it without touching the elements.
+template <typename Array>
+bool HashedArray<Array>::operator==(const HashedArray &other) const
+{
+    size_t ours = cached.load(std::memory_order_relaxed), theirs = other.cached.load(std::memory_order_relaxed);
+    if(ours != 0 && theirs != 0 && ours != theirs)
+        return false;
+    return array == other.array;
+}
+
+template <typename Array>
+template <typename... Args>
+auto HashedArray<Array>::pop(Args &&...args)
+{
+    auto output = array.pop(std::forward<Args>(args)...);
+    forget();
+    return output;
+}
+
+// Runs f(array) for changes the structural mutators do not cover, e.g. writing elements in place, and forgets
+// the cached hash afterwards (even if f throws). References f keeps to the elements must not outlive the call.
+template <typename Array>
+template <typename F> requires std::invocable<F &, Array &>
+decltype(auto) HashedArray<Array>::modify(F f)
+{
+    struct forgetting
+    {
+        HashedArray *owner;
+        ~forgetting() { owner->forget(); }
+    } guard{this};
+    return std::invoke(f, array);
+}
+
+template <typename Array>
+struct std::hash<HashedArray<Array>>
+{
+    size_t operator()(const HashedArray<Array> &array) const { return array.hash(); }
+};
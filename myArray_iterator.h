@@ -0,0 +1,79 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+template <typename C>
+class Node;
+
+// Random-access iterator over a LinkedStorage buffer. The nodes sit next to each other in memory, so it steps
+// through them with pointer arithmetic (not get_next()) and dereferences to the element stored in each node.
+template <typename T, bool Const>
+class nodeIterator
+{
+private:
+    using NodeType = std::conditional_t<Const, const Node<T>, Node<T>>;
+    NodeType *node = nullptr;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T, T> *;
+    using reference = std::conditional_t<Const, const T, T> &;
+    nodeIterator() = default;
+    explicit nodeIterator(NodeType *node) : node(node) {};
+    operator nodeIterator<T, true>() const requires (!Const) { return nodeIterator<T, true>(node); };
+    reference operator*() const { return node->get_data(); };
+    pointer operator->() const { return &node->get_data(); };
+    reference operator[](difference_type offset) const { return node[offset].get_data(); };
+    nodeIterator &operator++() { ++node; return *this; };
+    nodeIterator operator++(int) { nodeIterator old = *this; ++node; return old; };
+    nodeIterator &operator--() { --node; return *this; };
+    nodeIterator operator--(int) { nodeIterator old = *this; --node; return old; };
+    nodeIterator &operator+=(difference_type offset) { node += offset; return *this; };
+    nodeIterator &operator-=(difference_type offset) { node -= offset; return *this; };
+    friend nodeIterator operator+(nodeIterator it, difference_type offset) { return it += offset; };
+    friend nodeIterator operator+(difference_type offset, nodeIterator it) { return it += offset; };
+    friend nodeIterator operator-(nodeIterator it, difference_type offset) { return it -= offset; };
+    friend difference_type operator-(const nodeIterator &first, const nodeIterator &second) { return first.node - second.node; };
+    friend bool operator==(const nodeIterator &first, const nodeIterator &second) { return first.node == second.node; };
+    friend auto operator<=>(const nodeIterator &first, const nodeIterator &second) { return first.node <=> second.node; };
+};
+
+// Random-access iterator for layouts where elements are not at consecutive addresses (GapStorage): it keeps a
+// logical index and goes through the array's operator() on every dereference.
+template <typename Array, bool Const>
+class indexIterator
+{
+private:
+    using ArrayType = std::conditional_t<Const, const Array, Array>;
+    ArrayType *array = nullptr;
+    std::ptrdiff_t index = 0;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = typename Array::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const value_type, value_type> *;
+    using reference = std::conditional_t<Const, const value_type, value_type> &;
+    indexIterator() = default;
+    indexIterator(ArrayType *array, std::ptrdiff_t index) : array(array), index(index) {};
+    operator indexIterator<Array, true>() const requires (!Const) { return indexIterator<Array, true>(array, index); };
+    reference operator*() const { return (*array)(index); };
+    pointer operator->() const { return &(*array)(index); };
+    reference operator[](difference_type offset) const { return (*array)(index + offset); };
+    indexIterator &operator++() { ++index; return *this; };
+    indexIterator operator++(int) { indexIterator old = *this; ++index; return old; };
+    indexIterator &operator--() { --index; return *this; };
+    indexIterator operator--(int) { indexIterator old = *this; --index; return old; };
+    indexIterator &operator+=(difference_type offset) { index += offset; return *this; };
+    indexIterator &operator-=(difference_type offset) { index -= offset; return *this; };
+    friend indexIterator operator+(indexIterator it, difference_type offset) { return it += offset; };
+    friend indexIterator operator+(difference_type offset, indexIterator it) { return it += offset; };
+    friend indexIterator operator-(indexIterator it, difference_type offset) { return it -= offset; };
+    friend difference_type operator-(const indexIterator &first, const indexIterator &second) { return first.index - second.index; };
+    friend bool operator==(const indexIterator &first, const indexIterator &second) { return first.index == second.index; };
+    friend auto operator<=>(const indexIterator &first, const indexIterator &second) { return first.index <=> second.index; };
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Settings shared by every multi-threaded myArray operation: arrays shorter than `threshold`
+// elements are always processed on the calling thread, longer ones are split across `threads` workers.
+struct parallelSettings
+{
+    static inline size_t threshold = 1 << 16;
+    static inline unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+};
+
+namespace arrayParallel
+{
+    // Execution policies taken by vectorise(), map(), countIf() and the predicates. They only choose between the
+    // calling thread and forChunks(), so they are plain tags and need neither <execution> nor a parallel backend;
+    // myArray_execution.h lets the std::execution policies be passed as well.
+    struct sequencedPolicy {};
+    struct unsequencedPolicy {};
+    struct parallelPolicy {};
+    struct parallelUnsequencedPolicy {};
+    inline constexpr sequencedPolicy seq{};
+    inline constexpr unsequencedPolicy unseq{};
+    inline constexpr parallelPolicy par{};
+    inline constexpr parallelUnsequencedPolicy par_unseq{};
+
+    // Specialised for every type that is accepted as a policy; `parallel` tells whether it may use several threads.
+    template <typename Policy>
+    struct policyTraits {};
+    template <>
+    struct policyTraits<sequencedPolicy> { static constexpr bool parallel = false; };
+    template <>
+    struct policyTraits<unsequencedPolicy> { static constexpr bool parallel = false; };
+    template <>
+    struct policyTraits<parallelPolicy> { static constexpr bool parallel = true; };
+    template <>
+    struct policyTraits<parallelUnsequencedPolicy> { static constexpr bool parallel = true; };
+
+    template <typename Policy>
+    concept executionPolicy = requires {
+        { policyTraits<std::remove_cvref_t<Policy>>::parallel } -> std::convertible_to<bool>;
+    };
+
+    template <executionPolicy Policy>
+    inline constexpr bool runsInParallel = policyTraits<std::remove_cvref_t<Policy>>::parallel;
+
+    // Number of chunks an array of n elements is split into.
+    inline unsigned chunksFor(size_t n)
+    {
+        if(n < parallelSettings::threshold || parallelSettings::threads < 2)
+            return 1;
+        return static_cast<unsigned>(std::min<size_t>(parallelSettings::threads, n));
+    }
+
+    // Calls task(begin, end, chunk) for `chunks` consecutive pieces of [0, n), one thread per piece.
+    // The first exception thrown by a task is rethrown on the calling thread once all workers are done.
+    template <typename Task>
+    void forChunks(size_t n, unsigned chunks, Task &&task)
+    {
+        if(chunks <= 1)
+        {
+            task(size_t(0), n, 0u);
+            return;
+        }
+        std::vector<std::exception_ptr> errors(chunks);
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+        auto run = [&](unsigned chunk) {
+            try {
+                task(n * chunk / chunks, n * (chunk + 1) / chunks, chunk);
+            } catch (...) {
+                errors[chunk] = std::current_exception();
+            }
+        };
+        for(unsigned chunk = 1; chunk < chunks; ++chunk)
+            workers.emplace_back(run, chunk);
+        run(0);
+        for(auto &worker: workers)
+            worker.join();
+        for(auto &error: errors)
+            if(error)
+                std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,414 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace arrayPattern
+{
+    // Passes a match to a search callback; callbacks that return bool stop the search by returning false.
+    template <typename F, typename Match>
+    bool report(F &f, const Match &match)
+    {
+        if constexpr (std::is_same_v<std::invoke_result_t<F &, const Match &>, bool>)
+            return std::invoke(f, match);
+        else
+        {
+            std::invoke(f, match);
+            return true;
+        }
+    }
+}
+
+// Search pattern compiled once and reused for any number of searches, e.g. the codons MolecularArray looks
+// for over and over. The tables are built in the constructor and never change afterwards, so one Pattern can be
+// shared by several threads. The algorithm is chosen from the element type and the pattern length:
+// - Scan: single-byte elements and short patterns: memchr for the first element, then memcmp for the rest;
+// - Horspool: single-byte elements and patterns of at least horspoolMinimum elements: Boyer-Moore-Horspool
+//   with a 256-entry shift table, skipping up to the whole pattern length per step;
+// - Kmp: every other element type: Knuth-Morris-Pratt, which only needs operator==.
+// Scan and Horspool need contiguous text; other texts (linked arrays, ropes) are searched with Kmp, which reads the
+// text once from front to back through a single advancing iterator.
+template <typename T>
+class Pattern
+{
+public:
+    enum class Algorithm { Kmp, Scan, Horspool };
+    static constexpr size_t horspoolMinimum = 8;
+    Pattern(const T *elements, size_t count);
+    template <std::ranges::input_range Range>
+            requires (!std::is_array_v<Range>) && std::convertible_to<std::ranges::range_reference_t<const Range &>, T>
+    explicit Pattern(const Range &elements);
+    size_t length() const { return needle.size(); };
+    bool empty() const { return needle.empty(); };
+    Algorithm algorithm() const { return method; };
+    const T &operator[](size_t index) const { return needle[index]; };
+    template <std::random_access_iterator It>
+    size_t find(It first, It last, size_t from = 0) const;
+    template <std::random_access_iterator It, typename F>
+    void forEachMatch(It first, It last, F f, size_t from = 0) const;
+private:
+    // elements that can be compared and hashed as single bytes
+    static constexpr bool bytewise = sizeof(T) == 1 && std::has_unique_object_representations_v<T>;
+    std::vector<T> needle;
+    std::vector<size_t> failure;
+    std::vector<size_t> shift;
+    Algorithm method;
+    void compile();
+    static unsigned char byte(const T &element) { return std::bit_cast<unsigned char>(element); };
+    template <typename It, typename F>
+    void kmp(It first, size_t n, size_t from, F &f) const;
+    size_t scan(const T *data, size_t n, size_t from) const;
+    size_t horspool(const T *data, size_t n, size_t from) const;
+};
+
+
+template <typename T>
+Pattern<T>::Pattern(const T *elements, size_t count) : needle(elements, elements + count)
+{
+    compile();
+}
+
+template <typename T>
+template <std::ranges::input_range Range>
+        requires (!std::is_array_v<Range>) && std::convertible_to<std::ranges::range_reference_t<const Range &>, T>
+Pattern<T>::Pattern(const Range &elements)
+{
+    for(const auto &element: elements)
+        needle.push_back(element);
+    compile();
+}
+
+template <typename T>
+void Pattern<T>::compile()
+{
+    size_t m = needle.size();
+    if(bytewise && m >= horspoolMinimum)
+    {
+        method = Algorithm::Horspool;
+        if constexpr (bytewise)
+        {
+            shift.assign(256, m);
+            for(size_t i = 0; i + 1 < m; ++i)
+                shift[byte(needle[i])] = m - 1 - i;
+        }
+    }
+    else
+        method = bytewise ? Algorithm::Scan : Algorithm::Kmp;
+    // the failure table is also the fallback of Scan and Horspool when the haystack is not contiguous
+    failure.assign(m, 0);
+    for(size_t i = 1, j = 0; i < m;)
+    {
+        if(needle[i] == needle[j])
+            failure[i++] = ++j;
+        else if(j != 0)
+            j = failure[j - 1];
+        else
+            failure[i++] = 0;
+    }
+}
+
+// Position (relative to `first`) of the first occurrence starting at or after `from`, or last - first if there
+// is none. An empty pattern matches at `from`.
+template <typename T>
+template <std::random_access_iterator It>
+size_t Pattern<T>::find(It first, It last, size_t from) const
+{
+    auto n = static_cast<size_t>(last - first);
+    size_t m = needle.size();
+    if(from > n || m > n - from)
+        return n;
+    if(m == 0)
+        return from;
+    if constexpr (bytewise && std::contiguous_iterator<It>)
+    {
+        if(method == Algorithm::Horspool)
+            return horspool(std::to_address(first), n, from);
+        return scan(std::to_address(first), n, from);
+    }
+    size_t found = n;
+    auto stopAtFirst = [&](size_t position) { found = position; return false; };
+    kmp(first, n, from, stopAtFirst);
+    return found;
+}
+
+// Calls f(position) for every occurrence starting at or after `from`, overlapping ones included, in increasing
+// order; returning false from f stops the search. KMP continues from the failure table after each match, so the
+// whole scan stays O(n + m); the other algorithms restart one element after the previous match.
+template <typename T>
+template <std::random_access_iterator It, typename F>
+void Pattern<T>::forEachMatch(It first, It last, F f, size_t from) const
+{
+    auto n = static_cast<size_t>(last - first);
+    if(needle.empty())
+    {
+        for(size_t i = from; i < n; ++i)
+            if(!arrayPattern::report(f, i))
+                return;
+    }
+    else if(method == Algorithm::Kmp)
+        kmp(first, n, from, f);
+    else
+        for(size_t i = find(first, last, from); i < n; i = find(first, last, i + 1))
+            if(!arrayPattern::report(f, i))
+                return;
+}
+
+template <typename T>
+template <typename It, typename F>
+void Pattern<T>::kmp(It first, size_t n, size_t from, F &f) const
+{
+    size_t m = needle.size();
+    It at = first + from;
+    for(size_t i = from, j = 0; i < n;)
+    {
+        if(*at == needle[j])
+        {
+            ++i;
+            ++at;
+            if(++j == m)
+            {
+                if(!arrayPattern::report(f, i - m))
+                    return;
+                j = failure[m - 1];
+            }
+        }
+        else if(j != 0)
+            j = failure[j - 1];
+        else
+        {
+            ++i;
+            ++at;
+        }
+    }
+}
+
+template <typename T>
+size_t Pattern<T>::scan(const T *data, size_t n, size_t from) const
+{
+    size_t m = needle.size();
+    // only positions up to n - m can start a match
+    for(size_t i = from; i <= n - m; ++i)
+    {
+        auto hit = static_cast<const T *>(std::memchr(data + i, byte(needle[0]), n - m + 1 - i));
+        if(!hit)
+            break;
+        i = hit - data;
+        if(std::memcmp(data + i + 1, needle.data() + 1, m - 1) == 0)
+            return i;
+    }
+    return n;
+}
+
+template <typename T>
+size_t Pattern<T>::horspool(const T *data, size_t n, size_t from) const
+{
+    size_t m = needle.size();
+    for(size_t i = from; i <= n - m;)
+    {
+        const T &back = data[i + m - 1];
+        if(back == needle[m - 1] && std::memcmp(data + i, needle.data(), m - 1) == 0)
+            return i;
+        i += shift[byte(back)];
+    }
+    return n;
+}
+
+// Set of patterns searched in a single pass (Aho-Corasick). The trie of all patterns is turned into a complete
+// automaton whose transition table is indexed by a compacted alphabet: only elements that occur in some pattern
+// get their own column, everything else shares column 0. For DNA codons that is 5 columns per state, so the whole
+// table stays in L1 and each element of the haystack costs one table lookup, however many patterns there are.
+// Like Pattern, a PatternSet is immutable after construction and can be shared between threads.
+template <typename T>
+class PatternSet
+{
+public:
+    struct Match
+    {
+        size_t position;
+        size_t pattern;
+        bool operator==(const Match &) const = default;
+    };
+    template <std::ranges::input_range Patterns>
+            requires std::ranges::input_range<std::ranges::range_reference_t<const Patterns &>>
+    explicit PatternSet(const Patterns &patterns);
+    size_t patterns() const { return lengths.size(); };
+    size_t states() const { return outputStart.size() - 1; };
+    size_t alphabet() const { return columns; };
+    template <std::input_iterator It, typename F>
+    void forEachMatch(It first, It last, F f) const;
+    template <std::input_iterator It>
+    std::vector<Match> findAll(It first, It last) const;
+    template <std::random_access_iterator It>
+    Match findFirst(It first, It last, size_t from = 0) const;
+private:
+    static constexpr bool bytewise = sizeof(T) == 1 && std::has_unique_object_representations_v<T>;
+    // symbol (column) of every byte value, or the sorted elements of the alphabet for other types
+    std::conditional_t<bytewise, std::vector<uint16_t>, std::vector<T>> symbols;
+    size_t columns = 1;
+    std::vector<uint32_t> delta;
+    // patterns recognised in state s: outputs[outputStart[s] .. outputStart[s + 1])
+    std::vector<uint32_t> outputStart;
+    std::vector<uint32_t> outputs;
+    std::vector<size_t> lengths;
+    size_t longest = 0;
+    size_t symbol(const T &element) const;
+};
+
+
+template <typename T>
+template <std::ranges::input_range Patterns>
+        requires std::ranges::input_range<std::ranges::range_reference_t<const Patterns &>>
+PatternSet<T>::PatternSet(const Patterns &patterns)
+{
+    std::vector<std::vector<T>> elements;
+    for(const auto &pattern: patterns)
+    {
+        auto &added = elements.emplace_back();
+        for(const auto &element: pattern)
+            added.push_back(element);
+        if(added.empty())
+            throw std::invalid_argument("Empty pattern.");
+        lengths.push_back(added.size());
+        longest = std::max(longest, added.size());
+    }
+    // compact alphabet: column 0 is every element no pattern contains
+    if constexpr (bytewise)
+    {
+        symbols.assign(256, 0);
+        for(const auto &pattern: elements)
+            for(const T &element: pattern)
+                if(symbols[std::bit_cast<unsigned char>(element)] == 0)
+                    symbols[std::bit_cast<unsigned char>(element)] = static_cast<uint16_t>(columns++);
+    }
+    else
+    {
+        for(const auto &pattern: elements)
+            symbols.insert(symbols.end(), pattern.begin(), pattern.end());
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+        columns = symbols.size() + 1;
+    }
+
+    // trie, with missing transitions marked as 0 (the root is never a child)
+    std::vector<std::vector<uint32_t>> own(1);
+    delta.assign(columns, 0);
+    for(size_t id = 0; id < elements.size(); ++id)
+    {
+        uint32_t state = 0;
+        for(const T &element: elements[id])
+        {
+            uint32_t &next = delta[state * columns + symbol(element)];
+            if(next == 0)
+            {
+                next = static_cast<uint32_t>(own.size());
+                own.emplace_back();
+                delta.resize(own.size() * columns, 0);
+            }
+            state = delta[state * columns + symbol(element)];
+        }
+        own[state].push_back(static_cast<uint32_t>(id));
+    }
+
+    // breadth-first: failure links, missing transitions filled in from the failure state, and outputs merged
+    // with those of the failure state, so matching never has to follow a failure link
+    std::vector<uint32_t> failure(own.size(), 0);
+    std::vector<std::vector<uint32_t>> recognised(own.size());
+    std::vector<uint32_t> queue;
+    for(size_t c = 0; c < columns; ++c)
+        if(uint32_t child = delta[c])
+            queue.push_back(child);
+    for(size_t head = 0; head < queue.size(); ++head)
+    {
+        uint32_t state = queue[head];
+        recognised[state] = own[state];
+        auto &inherited = recognised[failure[state]];
+        recognised[state].insert(recognised[state].end(), inherited.begin(), inherited.end());
+        for(size_t c = 0; c < columns; ++c)
+        {
+            uint32_t &next = delta[state * columns + c];
+            uint32_t fallback = delta[failure[state] * columns + c];
+            if(next == 0)
+                next = fallback;
+            else
+            {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+    outputStart.push_back(0);
+    for(auto &ids: recognised)
+    {
+        outputs.insert(outputs.end(), ids.begin(), ids.end());
+        outputStart.push_back(static_cast<uint32_t>(outputs.size()));
+    }
+}
+
+template <typename T>
+size_t PatternSet<T>::symbol(const T &element) const
+{
+    if constexpr (bytewise)
+        return symbols[std::bit_cast<unsigned char>(element)];
+    else
+    {
+        auto found = std::lower_bound(symbols.begin(), symbols.end(), element);
+        return found != symbols.end() && *found == element ? found - symbols.begin() + 1 : 0;
+    }
+}
+
+// Calls f(Match) for every occurrence of every pattern, in order of the position where the occurrence ends.
+// If f returns bool, returning false stops the scan.
+template <typename T>
+template <std::input_iterator It, typename F>
+void PatternSet<T>::forEachMatch(It first, It last, F f) const
+{
+    uint32_t state = 0;
+    for(size_t i = 0; first != last; ++first, ++i)
+    {
+        state = delta[state * columns + symbol(*first)];
+        for(uint32_t o = outputStart[state]; o < outputStart[state + 1]; ++o)
+        {
+            if(!arrayPattern::report(f, Match{i + 1 - lengths[outputs[o]], outputs[o]}))
+                return;
+        }
+    }
+}
+
+template <typename T>
+template <std::input_iterator It>
+std::vector<typename PatternSet<T>::Match> PatternSet<T>::findAll(It first, It last) const
+{
+    std::vector<Match> output;
+    forEachMatch(first, last, [&](const Match &match) { output.push_back(match); });
+    return output;
+}
+
+// Leftmost occurrence starting at or after `from` (the lowest pattern id among those starting there), or
+// {last - first, patterns()} if there is none. The scan stops as soon as no later match can start earlier.
+template <typename T>
+template <std::random_access_iterator It>
+typename PatternSet<T>::Match PatternSet<T>::findFirst(It first, It last, size_t from) const
+{
+    auto n = static_cast<size_t>(last - first);
+    Match best{n, patterns()};
+    if(from >= n)
+        return best;
+    size_t end = from;
+    forEachMatch(first + from, last, [&](const Match &match) {
+        end = from + match.position + lengths[match.pattern];
+        Match found{from + match.position, match.pattern};
+        if(found.position < best.position || (found.position == best.position && found.pattern < best.pattern))
+            best = found;
+        // later matches end after `end`, so none can start before end - longest + 1
+        return end < best.position + longest;
+    });
+    return best;
+}
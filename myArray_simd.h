@@ -0,0 +1,432 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MYARRAY_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+// Search and reduction kernels behind myArray::index(), count(), in(), sum(), min() and max() for contiguous
+// arithmetic buffers. On x86 the AVX2 (or SSE2) version is picked at run time from the CPU features, everywhere
+// else the scalar loop is used.
+namespace arraySimd
+{
+    template <typename T>
+    concept vectorizable = std::is_arithmetic_v<T> &&
+            (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    template <typename T>
+    size_t findScalar(const T *data, size_t n, T value)
+    {
+        for(size_t i = 0; i < n; ++i)
+            if(data[i] == value)
+                return i;
+        return n;
+    }
+
+    template <typename T>
+    size_t countScalar(const T *data, size_t n, T value)
+    {
+        size_t output = 0;
+        for(size_t i = 0; i < n; ++i)
+            output += data[i] == value;
+        return output;
+    }
+
+    // Element types sum(), min() and max() have vector kernels for (bool has no meaningful lane arithmetic).
+    template <typename T>
+    concept reducible = vectorizable<T> && !std::is_same_v<T, bool>;
+
+    template <typename T>
+    T sumScalar(const T *data, size_t n)
+    {
+        T output{};
+        for(size_t i = 0; i < n; ++i)
+            output = static_cast<T>(output + data[i]);
+        return output;
+    }
+
+    // Kahan-Babuska (Neumaier) summation: a running correction term recovers the low-order bits every addition
+    // loses, so the error no longer grows with n.
+    template <typename T>
+    std::pair<T, T> compensatedSum(const T *data, size_t n, T output = T{}, T correction = T{})
+    {
+        for(size_t i = 0; i < n; ++i)
+        {
+            T next = output + data[i];
+            if(std::abs(output) >= std::abs(data[i]))
+                correction += (output - next) + data[i];
+            else
+                correction += (data[i] - next) + output;
+            output = next;
+        }
+        return {output, correction};
+    }
+
+    template <typename T>
+    bool isNan(const T &value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            return value != value;
+        else
+            return false;
+    }
+
+    // Adds one element to a running {smallest, largest}. NaN elements are skipped like in std::fmin/std::fmax:
+    // a NaN range only means that nothing but NaN has been seen, and the next element replaces it.
+    template <typename T>
+    void widen(std::pair<T, T> &range, const T &value)
+    {
+        if(isNan(range.first))
+            range = {value, value};
+        else
+        {
+            if(value < range.first)
+                range.first = value;
+            if(value > range.second)
+                range.second = value;
+        }
+    }
+
+    // Smallest and largest element of a non-empty range, in one pass; NaN only if every element is NaN.
+    template <typename T>
+    std::pair<T, T> minmaxScalar(const T *data, size_t n)
+    {
+        std::pair<T, T> output{data[0], data[0]};
+        for(size_t i = 1; i < n; ++i)
+            widen(output, data[i]);
+        return output;
+    }
+
+#ifdef MYARRAY_X86_SIMD
+    struct cpuFeatures
+    {
+        bool sse2;
+        bool avx2;
+    };
+
+    inline const cpuFeatures &cpu()
+    {
+        static const cpuFeatures features = [] {
+            __builtin_cpu_init();
+            return cpuFeatures{__builtin_cpu_supports("sse2") != 0, __builtin_cpu_supports("avx2") != 0};
+        }();
+        return features;
+    }
+
+    // Equality mask of 32 bytes: one bit per byte, so a 2-byte element owns 2 bits and wider ones 4 or 8.
+    template <typename T>
+    __attribute__((target("avx2"))) inline unsigned equalMask256(const T *data, __m256i needle)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+        if constexpr (std::is_same_v<T, float>)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(
+                    _mm256_cmp_ps(_mm256_castsi256_ps(block), _mm256_castsi256_ps(needle), _CMP_EQ_OQ))));
+        else if constexpr (std::is_same_v<T, double>)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(
+                    _mm256_cmp_pd(_mm256_castsi256_pd(block), _mm256_castsi256_pd(needle), _CMP_EQ_OQ))));
+        else if constexpr (sizeof(T) == 1)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)));
+        else if constexpr (sizeof(T) == 2)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(block, needle)));
+        else if constexpr (sizeof(T) == 4)
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(block, needle)));
+        else
+            return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(block, needle)));
+    }
+
+    template <typename T>
+    __attribute__((target("avx2"))) inline __m256i splat256(T value)
+    {
+        if constexpr (sizeof(T) == 1)
+            return _mm256_set1_epi8(std::bit_cast<char>(value));
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_set1_epi16(std::bit_cast<short>(value));
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_set1_epi32(std::bit_cast<int>(value));
+        else
+            return _mm256_set1_epi64x(std::bit_cast<long long>(value));
+    }
+
+    template <typename T>
+    __attribute__((target("avx2,popcnt"))) size_t findAvx2(const T *data, size_t n, T value)
+    {
+        constexpr size_t lanes = 32 / sizeof(T);
+        __m256i needle = splat256(value);
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes)
+            if(unsigned mask = equalMask256(data + i, needle))
+                return i + std::countr_zero(mask) / sizeof(T);
+        return i + findScalar(data + i, n - i, value);
+    }
+
+    template <typename T>
+    __attribute__((target("avx2,popcnt"))) size_t countAvx2(const T *data, size_t n, T value)
+    {
+        constexpr size_t lanes = 32 / sizeof(T);
+        __m256i needle = splat256(value);
+        size_t bits = 0;
+        size_t i = 0;
+        for(; i + 2 * lanes <= n; i += 2 * lanes)
+            bits += std::popcount(equalMask256(data + i, needle)) + std::popcount(equalMask256(data + i + lanes, needle));
+        for(; i + lanes <= n; i += lanes)
+            bits += std::popcount(equalMask256(data + i, needle));
+        return bits / sizeof(T) + countScalar(data + i, n - i, value);
+    }
+
+    // Unaligned load of 32 bytes in the register type matching T.
+    template <typename T>
+    __attribute__((target("avx2"))) inline auto load256(const T *pointer)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return _mm256_loadu_ps(pointer);
+        else if constexpr (std::is_same_v<T, double>)
+            return _mm256_loadu_pd(pointer);
+        else
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pointer));
+    }
+
+    template <typename T, typename Vector>
+    __attribute__((target("avx2"))) inline Vector add256(Vector a, Vector b)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return _mm256_add_ps(a, b);
+        else if constexpr (std::is_same_v<T, double>)
+            return _mm256_add_pd(a, b);
+        else if constexpr (sizeof(T) == 1)
+            return _mm256_add_epi8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return _mm256_add_epi16(a, b);
+        else if constexpr (sizeof(T) == 4)
+            return _mm256_add_epi32(a, b);
+        else
+            return _mm256_add_epi64(a, b);
+    }
+
+    template <typename T, typename Vector>
+    __attribute__((target("avx2"))) inline Vector min256(Vector a, Vector b)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return _mm256_min_ps(a, b);
+        else if constexpr (std::is_same_v<T, double>)
+            return _mm256_min_pd(a, b);
+        else if constexpr (sizeof(T) == 1)
+            return std::is_signed_v<T> ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return std::is_signed_v<T> ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b);
+        else
+            return std::is_signed_v<T> ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+    }
+
+    template <typename T, typename Vector>
+    __attribute__((target("avx2"))) inline Vector max256(Vector a, Vector b)
+    {
+        if constexpr (std::is_same_v<T, float>)
+            return _mm256_max_ps(a, b);
+        else if constexpr (std::is_same_v<T, double>)
+            return _mm256_max_pd(a, b);
+        else if constexpr (sizeof(T) == 1)
+            return std::is_signed_v<T> ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b);
+        else if constexpr (sizeof(T) == 2)
+            return std::is_signed_v<T> ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b);
+        else
+            return std::is_signed_v<T> ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+    }
+
+    // Lane-wise sum: integers wrap around exactly like the scalar loop, floating point numbers are summed in
+    // 4 independent accumulators per lane, which is usually more accurate than a single running total.
+    template <reducible T>
+    __attribute__((target("avx2"))) T sumAvx2(const T *data, size_t n)
+    {
+        constexpr size_t lanes = 32 / sizeof(T);
+        using Vector = decltype(load256(data));
+        Vector accumulators[4] = {};
+        size_t i = 0;
+        for(; i + 4 * lanes <= n; i += 4 * lanes)
+            for(size_t k = 0; k < 4; ++k)
+                accumulators[k] = add256<T>(accumulators[k], load256(data + i + k * lanes));
+        for(; i + lanes <= n; i += lanes)
+            accumulators[0] = add256<T>(accumulators[0], load256(data + i));
+        Vector total = add256<T>(add256<T>(accumulators[0], accumulators[1]), add256<T>(accumulators[2], accumulators[3]));
+        alignas(32) T partial[lanes];
+        std::memcpy(partial, &total, sizeof(total));
+        return static_cast<T>(sumScalar(partial, lanes) + sumScalar(data + i, n - i));
+    }
+
+    // AVX2 has no 64-bit integer min/max, so those types stay scalar.
+    template <typename T>
+    concept minmaxVectorizable = reducible<T> && (sizeof(T) < 8 || std::is_floating_point_v<T>);
+
+    template <minmaxVectorizable T>
+    __attribute__((target("avx2"))) std::pair<T, T> minmaxAvx2(const T *data, size_t n)
+    {
+        constexpr size_t lanes = 32 / sizeof(T);
+        if(n < lanes)
+            return minmaxScalar(data, n);
+        auto smallest = load256(data);
+        auto largest = smallest;
+        size_t i = lanes;
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            // vector min/max return their second operand when either one is NaN, so with the accumulator second
+            // NaN elements are skipped as in minmaxScalar; the accumulators start at infinity, not at data[0..]
+            alignas(32) T bounds[2][lanes];
+            std::fill_n(bounds[0], lanes, std::numeric_limits<T>::infinity());
+            std::fill_n(bounds[1], lanes, -std::numeric_limits<T>::infinity());
+            smallest = load256(bounds[0]);
+            largest = load256(bounds[1]);
+            i = 0;
+        }
+        for(; i + lanes <= n; i += lanes)
+        {
+            auto block = load256(data + i);
+            smallest = min256<T>(block, smallest);
+            largest = max256<T>(block, largest);
+        }
+        // the last partial block is handled by re-reading the final full vector
+        if(i < n)
+        {
+            auto block = load256(data + n - lanes);
+            smallest = min256<T>(block, smallest);
+            largest = max256<T>(block, largest);
+        }
+        alignas(32) T low[lanes];
+        alignas(32) T high[lanes];
+        std::memcpy(low, &smallest, sizeof(smallest));
+        std::memcpy(high, &largest, sizeof(largest));
+        std::pair<T, T> output{minmaxScalar(low, lanes).first, minmaxScalar(high, lanes).second};
+        // only NaN elements leave the accumulators at +infinity and -infinity
+        if(output.first > output.second)
+            return {data[0], data[0]};
+        return output;
+    }
+
+    // SSE2 has no 64-bit integer compare, so 8-byte integers stay on the scalar path without AVX2.
+    template <typename T>
+    concept sse2Vectorizable = vectorizable<T> && (sizeof(T) < 8 || std::is_floating_point_v<T>);
+
+    template <typename T>
+    __attribute__((target("sse2"))) inline unsigned equalMask128(const T *data, __m128i needle)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        if constexpr (std::is_same_v<T, float>)
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castps_si128(
+                    _mm_cmpeq_ps(_mm_castsi128_ps(block), _mm_castsi128_ps(needle)))));
+        else if constexpr (std::is_same_v<T, double>)
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_castpd_si128(
+                    _mm_cmpeq_pd(_mm_castsi128_pd(block), _mm_castsi128_pd(needle)))));
+        else if constexpr (sizeof(T) == 1)
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        else if constexpr (sizeof(T) == 2)
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(block, needle)));
+        else
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(block, needle)));
+    }
+
+    template <typename T>
+    __attribute__((target("sse2"))) inline __m128i splat128(T value)
+    {
+        if constexpr (sizeof(T) == 1)
+            return _mm_set1_epi8(std::bit_cast<char>(value));
+        else if constexpr (sizeof(T) == 2)
+            return _mm_set1_epi16(std::bit_cast<short>(value));
+        else if constexpr (sizeof(T) == 4)
+            return _mm_set1_epi32(std::bit_cast<int>(value));
+        else
+        {
+            auto bits = std::bit_cast<std::uint64_t>(value);
+            return _mm_set_epi32(static_cast<int>(bits >> 32), static_cast<int>(bits),
+                                 static_cast<int>(bits >> 32), static_cast<int>(bits));
+        }
+    }
+
+    template <sse2Vectorizable T>
+    __attribute__((target("sse2"))) size_t findSse2(const T *data, size_t n, T value)
+    {
+        constexpr size_t lanes = 16 / sizeof(T);
+        __m128i needle = splat128(value);
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes)
+            if(unsigned mask = equalMask128(data + i, needle))
+                return i + std::countr_zero(mask) / sizeof(T);
+        return i + findScalar(data + i, n - i, value);
+    }
+
+    template <sse2Vectorizable T>
+    __attribute__((target("sse2"))) size_t countSse2(const T *data, size_t n, T value)
+    {
+        constexpr size_t lanes = 16 / sizeof(T);
+        __m128i needle = splat128(value);
+        size_t bits = 0;
+        size_t i = 0;
+        for(; i + lanes <= n; i += lanes)
+            bits += std::popcount(equalMask128(data + i, needle));
+        return bits / sizeof(T) + countScalar(data + i, n - i, value);
+    }
+#endif
+
+    // Index of the first element equal to `value`, or n if there is none.
+    template <typename T>
+    size_t find(const T *data, size_t n, T value)
+    {
+#ifdef MYARRAY_X86_SIMD
+        if constexpr (vectorizable<T>)
+        {
+            if(cpu().avx2)
+                return findAvx2(data, n, value);
+            if constexpr (sse2Vectorizable<T>)
+                if(cpu().sse2)
+                    return findSse2(data, n, value);
+        }
+#endif
+        return findScalar(data, n, value);
+    }
+
+    // Number of elements equal to `value`.
+    template <typename T>
+    size_t count(const T *data, size_t n, T value)
+    {
+#ifdef MYARRAY_X86_SIMD
+        if constexpr (vectorizable<T>)
+        {
+            if(cpu().avx2)
+                return countAvx2(data, n, value);
+            if constexpr (sse2Vectorizable<T>)
+                if(cpu().sse2)
+                    return countSse2(data, n, value);
+        }
+#endif
+        return countScalar(data, n, value);
+    }
+
+    template <typename T>
+    T sum(const T *data, size_t n)
+    {
+#ifdef MYARRAY_X86_SIMD
+        if constexpr (reducible<T>)
+            if(cpu().avx2)
+                return sumAvx2(data, n);
+#endif
+        return sumScalar(data, n);
+    }
+
+    // Smallest and largest element of a non-empty range.
+    template <typename T>
+    std::pair<T, T> minmax(const T *data, size_t n)
+    {
+#ifdef MYARRAY_X86_SIMD
+        if constexpr (minmaxVectorizable<T>)
+            if(cpu().avx2)
+                return minmaxAvx2(data, n);
+#endif
+        return minmaxScalar(data, n);
+    }
+}
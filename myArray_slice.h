@@ -0,0 +1,196 @@
+#pragma once
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "myArray_simd.h"
+
+// Non-owning strided view over [start, end] of a myArray, as returned by the three-argument operator[].
+// Elements are read from the underlying array on access, so a view must not outlive its array, and
+// appending to or reallocating the array invalidates it.
+template <typename Array>
+class arraySlice
+{
+public:
+    using value_type = typename Array::value_type;
+    class iterator;
+    arraySlice(const Array &array, long long start, long long end, long long step = 1);
+    size_t length() const { return count; };
+    bool empty() const { return count == 0; };
+    long long stride() const { return step; };
+    const value_type &operator[](size_t index) const { return array->value(physical(index)); };
+    const value_type &at(long long index) const;
+    iterator begin() const { return iterator(this, 0); };
+    iterator end() const { return iterator(this, count); };
+    value_type sum() const;
+    value_type min() const { return minmax().first; };
+    value_type max() const { return minmax().second; };
+    std::pair<value_type, value_type> minmax() const;
+    size_t countOf(const value_type &element) const;
+    template <typename Predicate>
+    size_t countIf(Predicate pred) const;
+    Array materialize() const;
+    operator Array() const { return materialize(); };
+    template <typename Other>
+    bool operator==(const arraySlice<Other> &second) const { return equal(second); };
+    bool operator==(const Array &second) const;
+private:
+    template <typename>
+    friend class arraySlice;
+    const Array *array;
+    size_t first;
+    size_t count;
+    long long step;
+    // Index inside the array of the index-th element of the view.
+    size_t physical(size_t index) const { return first + index * step; };
+    // Pointer to the elements if they are adjacent in memory (contiguous storage and step 1), otherwise null.
+    const value_type *contiguousData() const;
+    template <typename Other>
+    bool equal(const Other &second) const;
+};
+
+template <typename Array>
+class arraySlice<Array>::iterator
+{
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Array::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+    iterator() = default;
+    iterator(const arraySlice *view, size_t index) : view(view), index(index) {};
+    reference operator*() const { return (*view)[index]; };
+    pointer operator->() const { return &(*view)[index]; };
+    reference operator[](difference_type offset) const { return (*view)[index + offset]; };
+    iterator &operator++() { ++index; return *this; };
+    iterator operator++(int) { iterator old = *this; ++index; return old; };
+    iterator &operator--() { --index; return *this; };
+    iterator operator--(int) { iterator old = *this; --index; return old; };
+    iterator &operator+=(difference_type offset) { index += offset; return *this; };
+    iterator &operator-=(difference_type offset) { index -= offset; return *this; };
+    iterator operator+(difference_type offset) const { return iterator(view, index + offset); };
+    iterator operator-(difference_type offset) const { return iterator(view, index - offset); };
+    friend iterator operator+(difference_type offset, const iterator &it) { return it + offset; };
+    difference_type operator-(const iterator &other) const { return difference_type(index) - difference_type(other.index); };
+    bool operator==(const iterator &other) const { return index == other.index; };
+    auto operator<=>(const iterator &other) const { return index <=> other.index; };
+private:
+    const arraySlice *view = nullptr;
+    size_t index = 0;
+};
+
+
+template <typename Array>
+arraySlice<Array>::arraySlice(const Array &array, long long start, long long end, long long step) :
+        array(&array), step(step)
+{
+    long long len = array.length();
+    if(start < 0)
+        start += len;
+    if(end < 0)
+        end += len;
+    if(start >= len || start < 0 || end < 0 || end >= len || step == 0 || start > end)
+        throw std::out_of_range("Index is out of range.");
+    // a negative step walks the interval backwards, starting from `end`
+    first = step > 0 ? start : end;
+    count = (end - start) / (step > 0 ? step : -step) + 1;
+}
+
+template <typename Array>
+const typename arraySlice<Array>::value_type &arraySlice<Array>::at(long long index) const
+{
+    if(index < 0)
+        index += count;
+    if(index < 0 || std::cmp_greater_equal(index, count))
+        throw std::out_of_range("Index is out of range.");
+    return (*this)[index];
+}
+
+template <typename Array>
+const typename arraySlice<Array>::value_type *arraySlice<Array>::contiguousData() const
+{
+    if constexpr (Array::contiguous)
+        if(step == 1)
+            return array->buffer + first;
+    return nullptr;
+}
+
+template <typename Array>
+typename arraySlice<Array>::value_type arraySlice<Array>::sum() const
+{
+    if(auto data = contiguousData())
+        return arraySimd::sum(data, count);
+    value_type output{};
+    for(size_t i = 0; i < count; ++i)
+        output = output + (*this)[i];
+    return output;
+}
+
+template <typename Array>
+std::pair<typename arraySlice<Array>::value_type, typename arraySlice<Array>::value_type> arraySlice<Array>::minmax() const
+{
+    if(count == 0) throw std::out_of_range("Empty list.");
+    if(auto data = contiguousData())
+        return arraySimd::minmax(data, count);
+    std::pair<value_type, value_type> output{(*this)[0], (*this)[0]};
+    for(size_t i = 1; i < count; ++i)
+        arraySimd::widen(output, (*this)[i]);
+    return output;
+}
+
+template <typename Array>
+size_t arraySlice<Array>::countOf(const value_type &element) const
+{
+    if(auto data = contiguousData())
+        return arraySimd::count(data, count, element);
+    size_t output = 0;
+    for(size_t i = 0; i < count; ++i)
+        output += (*this)[i] == element;
+    return output;
+}
+
+template <typename Array>
+template <typename Predicate>
+size_t arraySlice<Array>::countIf(Predicate pred) const
+{
+    size_t output = 0;
+    for(size_t i = 0; i < count; ++i)
+        output += static_cast<bool>(pred((*this)[i]));
+    return output;
+}
+
+template <typename Array>
+Array arraySlice<Array>::materialize() const
+{
+    Array output(array->get_allocator());
+    output.reserve(count);
+    for(size_t i = 0; i < count; ++i)
+        output.append((*this)[i]);
+    return output;
+}
+
+template <typename Array>
+template <typename Other>
+bool arraySlice<Array>::equal(const Other &second) const
+{
+    if(second.length() != count)
+        return false;
+    for(size_t i = 0; i < count; ++i)
+        if(!((*this)[i] == second[i]))
+            return false;
+    return true;
+}
+
+template <typename Array>
+bool arraySlice<Array>::operator==(const Array &second) const
+{
+    if(second.length() != count)
+        return false;
+    for(size_t i = 0; i < count; ++i)
+        if(!((*this)[i] == second.value(i)))
+            return false;
+    return true;
+}
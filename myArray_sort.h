@@ -0,0 +1,427 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "myArray_parallel.h"
+
+// Sorting engines used by myArray::sort() and myArray::stable_sort(). All of them work on a contiguous
+// range [begin, end) and take a strict weak ordering `comp`.
+namespace arraySort
+{
+    constexpr std::ptrdiff_t insertionThreshold = 24;
+    constexpr std::ptrdiff_t nintherThreshold = 128;
+    constexpr std::ptrdiff_t partialInsertionLimit = 8;
+    constexpr std::ptrdiff_t mergeRun = 32;
+    constexpr size_t countingThreshold = 64;
+    constexpr size_t radixThreshold = 256;
+
+    template <typename It, typename Compare>
+    void insertionSort(It begin, It end, Compare &comp)
+    {
+        if(begin == end)
+            return;
+        for(It current = begin + 1; current != end; ++current)
+        {
+            It sift = current;
+            It previous = current - 1;
+            if(comp(*sift, *previous))
+            {
+                auto key = std::move(*sift);
+                do {
+                    *sift-- = std::move(*previous);
+                } while(sift != begin && comp(key, *--previous));
+                *sift = std::move(key);
+            }
+        }
+    }
+
+    // Same as insertionSort(), but relies on *(begin - 1) not being greater than any element in the range.
+    template <typename It, typename Compare>
+    void unguardedInsertionSort(It begin, It end, Compare &comp)
+    {
+        if(begin == end)
+            return;
+        for(It current = begin + 1; current != end; ++current)
+        {
+            It sift = current;
+            It previous = current - 1;
+            if(comp(*sift, *previous))
+            {
+                auto key = std::move(*sift);
+                do {
+                    *sift-- = std::move(*previous);
+                } while(comp(key, *--previous));
+                *sift = std::move(key);
+            }
+        }
+    }
+
+    // Insertion sort that gives up (returning false) once it had to move more than a handful of elements.
+    template <typename It, typename Compare>
+    bool partialInsertionSort(It begin, It end, Compare &comp)
+    {
+        if(begin == end)
+            return true;
+        std::ptrdiff_t moved = 0;
+        for(It current = begin + 1; current != end; ++current)
+        {
+            It sift = current;
+            It previous = current - 1;
+            if(comp(*sift, *previous))
+            {
+                auto key = std::move(*sift);
+                do {
+                    *sift-- = std::move(*previous);
+                } while(sift != begin && comp(key, *--previous));
+                *sift = std::move(key);
+                moved += current - sift;
+            }
+            if(moved > partialInsertionLimit)
+                return false;
+        }
+        return true;
+    }
+
+    template <typename It, typename Compare>
+    void sort2(It a, It b, Compare &comp)
+    {
+        if(comp(*b, *a))
+            std::iter_swap(a, b);
+    }
+
+    template <typename It, typename Compare>
+    void sort3(It a, It b, It c, Compare &comp)
+    {
+        sort2(a, b, comp);
+        sort2(b, c, comp);
+        sort2(a, b, comp);
+    }
+
+    // Partitions around the pivot *begin, putting elements equal to it on the right.
+    // Returns the final pivot position and whether the range was already partitioned.
+    template <typename It, typename Compare>
+    std::pair<It, bool> partitionRight(It begin, It end, Compare &comp)
+    {
+        auto pivot = std::move(*begin);
+        It first = begin;
+        It last = end;
+        while(comp(*++first, pivot));
+        if(first - 1 == begin)
+            while(first < last && !comp(*--last, pivot));
+        else
+            while(!comp(*--last, pivot));
+        bool alreadyPartitioned = first >= last;
+        while(first < last)
+        {
+            std::iter_swap(first, last);
+            while(comp(*++first, pivot));
+            while(!comp(*--last, pivot));
+        }
+        It pivotPosition = first - 1;
+        *begin = std::move(*pivotPosition);
+        *pivotPosition = std::move(pivot);
+        return {pivotPosition, alreadyPartitioned};
+    }
+
+    // Partitions around the pivot *begin, putting elements equal to it on the left. Used when the pivot equals
+    // the element preceding the range, so the whole left side is known to be equal and needs no more sorting.
+    template <typename It, typename Compare>
+    It partitionLeft(It begin, It end, Compare &comp)
+    {
+        auto pivot = std::move(*begin);
+        It first = begin;
+        It last = end;
+        while(comp(pivot, *--last));
+        if(last + 1 == end)
+            while(first < last && !comp(pivot, *++first));
+        else
+            while(!comp(pivot, *++first));
+        while(first < last)
+        {
+            std::iter_swap(first, last);
+            while(comp(pivot, *--last));
+            while(!comp(pivot, *++first));
+        }
+        *begin = std::move(*last);
+        *last = std::move(pivot);
+        return last;
+    }
+
+    template <typename It, typename Compare>
+    void pdqsortLoop(It begin, It end, Compare &comp, int badAllowed, bool leftmost)
+    {
+        while(true)
+        {
+            std::ptrdiff_t size = end - begin;
+            if(size < insertionThreshold)
+            {
+                if(leftmost)
+                    insertionSort(begin, end, comp);
+                else
+                    unguardedInsertionSort(begin, end, comp);
+                return;
+            }
+
+            std::ptrdiff_t half = size / 2;
+            if(size > nintherThreshold)
+            {
+                sort3(begin, begin + half, end - 1, comp);
+                sort3(begin + 1, begin + (half - 1), end - 2, comp);
+                sort3(begin + 2, begin + (half + 1), end - 3, comp);
+                sort3(begin + (half - 1), begin + half, begin + (half + 1), comp);
+                std::iter_swap(begin, begin + half);
+            }
+            else
+                sort3(begin + half, begin, end - 1, comp);
+
+            if(!leftmost && !comp(*(begin - 1), *begin))
+            {
+                begin = partitionLeft(begin, end, comp) + 1;
+                continue;
+            }
+
+            auto [pivot, alreadyPartitioned] = partitionRight(begin, end, comp);
+            std::ptrdiff_t leftSize = pivot - begin;
+            std::ptrdiff_t rightSize = end - (pivot + 1);
+            if(leftSize < size / 8 || rightSize < size / 8)
+            {
+                // a bad partition: fall back to heapsort when it keeps happening, otherwise break up the pattern
+                if(--badAllowed == 0)
+                {
+                    std::make_heap(begin, end, comp);
+                    std::sort_heap(begin, end, comp);
+                    return;
+                }
+                if(leftSize >= insertionThreshold)
+                {
+                    std::iter_swap(begin, begin + leftSize / 4);
+                    std::iter_swap(pivot - 1, pivot - leftSize / 4);
+                    if(leftSize > nintherThreshold)
+                    {
+                        std::iter_swap(begin + 1, begin + (leftSize / 4 + 1));
+                        std::iter_swap(begin + 2, begin + (leftSize / 4 + 2));
+                        std::iter_swap(pivot - 2, pivot - (leftSize / 4 + 1));
+                        std::iter_swap(pivot - 3, pivot - (leftSize / 4 + 2));
+                    }
+                }
+                if(rightSize >= insertionThreshold)
+                {
+                    std::iter_swap(pivot + 1, pivot + (1 + rightSize / 4));
+                    std::iter_swap(end - 1, end - rightSize / 4);
+                    if(rightSize > nintherThreshold)
+                    {
+                        std::iter_swap(pivot + 2, pivot + (2 + rightSize / 4));
+                        std::iter_swap(pivot + 3, pivot + (3 + rightSize / 4));
+                        std::iter_swap(end - 2, end - (1 + rightSize / 4));
+                        std::iter_swap(end - 3, end - (2 + rightSize / 4));
+                    }
+                }
+            }
+            else if(alreadyPartitioned && partialInsertionSort(begin, pivot, comp) &&
+                    partialInsertionSort(pivot + 1, end, comp))
+                return;
+
+            pdqsortLoop(begin, pivot, comp, badAllowed, leftmost);
+            begin = pivot + 1;
+            leftmost = false;
+        }
+    }
+
+    // Pattern-defeating quicksort: O(n log n) worst case, linear on sorted, reversed and equal-key inputs.
+    template <typename It, typename Compare>
+    void pdqsort(It begin, It end, Compare comp)
+    {
+        if(end - begin < 2)
+            return;
+        int badAllowed = static_cast<int>(std::log2(static_cast<double>(end - begin))) + 1;
+        pdqsortLoop(begin, end, comp, badAllowed, true);
+    }
+
+    // One bottom-up merge pass: merges neighbouring sorted runs of `width` elements from `from` into `to`.
+    // The comparator sees the elements as lvalues, as in the other kernels; only the winner is moved.
+    template <typename T, typename Compare>
+    void mergePass(T *from, T *to, size_t n, size_t width, Compare &comp, unsigned chunks)
+    {
+        size_t pairs = (n + 2 * width - 1) / (2 * width);
+        arrayParallel::forChunks(pairs, std::min<size_t>(chunks, pairs), [&](size_t first, size_t last, unsigned) {
+            for(size_t pair = first; pair < last; ++pair)
+            {
+                size_t begin = pair * 2 * width;
+                size_t middle = std::min(begin + width, n);
+                size_t end = std::min(begin + 2 * width, n);
+                T *left = from + begin, *right = from + middle, *out = to + begin;
+                while(left != from + middle && right != from + end)
+                    *out++ = comp(*right, *left) ? std::move(*right++) : std::move(*left++);
+                out = std::move(left, from + middle, out);
+                std::move(right, from + end, out);
+            }
+        });
+    }
+
+    // Stable bottom-up merge sort. Runs of mergeRun elements are insertion sorted first; with more than one
+    // chunk the runs are sorted and merged on several threads.
+    template <typename T, typename Compare>
+    void mergeSort(T *data, size_t n, Compare comp, unsigned chunks = 1)
+    {
+        if(n <= static_cast<size_t>(mergeRun))
+        {
+            insertionSort(data, data + n, comp);
+            return;
+        }
+        size_t runs = (n + mergeRun - 1) / mergeRun;
+        arrayParallel::forChunks(runs, std::min<size_t>(chunks, runs), [&](size_t first, size_t last, unsigned) {
+            for(size_t run = first; run < last; ++run)
+                insertionSort(data + run * mergeRun, data + std::min(n, (run + 1) * mergeRun), comp);
+        });
+        std::vector<T> scratch(std::make_move_iterator(data), std::make_move_iterator(data + n));
+        T *from = scratch.data();
+        T *to = data;
+        for(size_t width = mergeRun; width < n; width *= 2)
+        {
+            mergePass(from, to, n, width, comp, chunks);
+            std::swap(from, to);
+        }
+        if(from != data)
+            std::move(from, from + n, data);
+    }
+
+    // Entry point for myArray::sort(): pdqsort on one thread, parallel merge sort for large arrays.
+    template <typename T, typename Compare>
+    void sort(T *data, size_t n, Compare comp)
+    {
+        unsigned chunks = arrayParallel::chunksFor(n);
+        if(chunks > 1)
+            mergeSort(data, n, comp, chunks);
+        else
+            pdqsort(data, data + n, comp);
+    }
+
+    // Entry point for myArray::stable_sort().
+    template <typename T, typename Compare>
+    void stableSort(T *data, size_t n, Compare comp)
+    {
+        mergeSort(data, n, comp, arrayParallel::chunksFor(n));
+    }
+
+    // Element types whose natural order can be reproduced by sorting an unsigned integer key byte by byte.
+    template <typename T>
+    concept radixSortable = (std::is_integral_v<T> || std::is_floating_point_v<T>) &&
+            (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    template <typename T>
+    using radixKeyType = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                         std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                         std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+    // Maps a value to an unsigned key with the same ordering: the sign bit of signed integers is flipped,
+    // negative floating point numbers have all bits inverted and positive ones get the sign bit set.
+    template <radixSortable T>
+    radixKeyType<T> radixKey(T value)
+    {
+        using Key = radixKeyType<T>;
+        constexpr Key sign = Key(1) << (8 * sizeof(T) - 1);
+        auto bits = std::bit_cast<Key>(value);
+        if constexpr (std::is_floating_point_v<T>)
+            return (bits & sign) ? Key(~bits) : Key(bits | sign);
+        else if constexpr (std::is_signed_v<T>)
+            return Key(bits ^ sign);
+        else
+            return bits;
+    }
+
+    template <radixSortable T>
+    T fromRadixKey(radixKeyType<T> key)
+    {
+        using Key = radixKeyType<T>;
+        constexpr Key sign = Key(1) << (8 * sizeof(T) - 1);
+        if constexpr (std::is_floating_point_v<T>)
+            return std::bit_cast<T>((key & sign) ? Key(key ^ sign) : Key(~key));
+        else if constexpr (std::is_signed_v<T>)
+            return std::bit_cast<T>(Key(key ^ sign));
+        else
+            return std::bit_cast<T>(key);
+    }
+
+    // 256-bucket counting sort for one-byte types: the values are rebuilt from the bucket counts,
+    // so no scratch buffer is needed. Descending order just walks the buckets backwards.
+    template <radixSortable T> requires (sizeof(T) == 1)
+    void countingSort(T *data, size_t n, bool reverse)
+    {
+        std::array<size_t, 256> counts{};
+        for(size_t i = 0; i < n; ++i)
+            ++counts[radixKey(data[i])];
+        T *out = data;
+        for(size_t bucket = 0; bucket < 256; ++bucket)
+        {
+            size_t key = reverse ? 255 - bucket : bucket;
+            if(counts[key] > 0)
+                out = std::fill_n(out, counts[key], fromRadixKey<T>(static_cast<std::uint8_t>(key)));
+        }
+    }
+
+    // LSD radix sort on 8-bit digits. All histograms are built in a single pass, digits shared by every element
+    // are skipped, and descending order sorts the complemented keys instead of needing a second pass.
+    template <radixSortable T>
+    void radixSort(T *data, size_t n, bool reverse)
+    {
+        using Key = radixKeyType<T>;
+        constexpr size_t passes = sizeof(T);
+        const Key flip = reverse ? Key(~Key(0)) : Key(0);
+        std::array<std::array<size_t, 256>, passes> histograms{};
+        for(size_t i = 0; i < n; ++i)
+        {
+            Key key = radixKey(data[i]) ^ flip;
+            for(size_t pass = 0; pass < passes; ++pass)
+                ++histograms[pass][(key >> (8 * pass)) & 0xFF];
+        }
+        std::vector<T> scratch(n);
+        T *from = data;
+        T *to = scratch.data();
+        for(size_t pass = 0; pass < passes; ++pass)
+        {
+            auto &counts = histograms[pass];
+            if(counts[((radixKey(from[0]) ^ flip) >> (8 * pass)) & 0xFF] == n)
+                continue;
+            size_t offset = 0;
+            for(auto &count: counts)
+                offset += std::exchange(count, offset);
+            for(size_t i = 0; i < n; ++i)
+                to[counts[((radixKey(from[i]) ^ flip) >> (8 * pass)) & 0xFF]++] = from[i];
+            std::swap(from, to);
+        }
+        if(from != data)
+            std::copy(from, from + n, data);
+    }
+
+    // Entry point for sort(bool reverse) and stable_sort(bool reverse): arithmetic types are dispatched at compile
+    // time to counting sort (one-byte types) or radix sort, everything else is compared with operator<.
+    // Floating point keys are compared when stability is asked for: the radix keys tell -0.0 from 0.0 and order
+    // NaNs by their bits, which would move elements that operator< treats as equal.
+    template <typename T>
+    void naturalSort(T *data, size_t n, bool reverse, bool stable)
+    {
+        if constexpr (radixSortable<T>)
+        {
+            if constexpr (sizeof(T) == 1)
+            {
+                if(n >= countingThreshold)
+                    return countingSort(data, n, reverse);
+            }
+            else if(n >= radixThreshold && !(std::is_floating_point_v<T> && stable))
+                return radixSort(data, n, reverse);
+        }
+        auto ascending = [](const T &a, const T &b) { return a < b; };
+        auto descending = [](const T &a, const T &b) { return b < a; };
+        if(stable)
+            reverse ? stableSort(data, n, descending) : stableSort(data, n, ascending);
+        else
+            reverse ? sort(data, n, descending) : sort(data, n, ascending);
+    }
+}
@@ -1,4 +1,10 @@
 #include "myArray_class.h"
+#include "myArray_execution.h"
+#include "myArray_fingerprint.h"
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <unordered_set>
 #include "gtest/gtest.h"
 
 
@@ -124,7 +130,13 @@ TEST(MyArrayTest, ClearArrayWithShrink)
     myArray<int> arr(values, 3);
     arr.clear(true);
     EXPECT_EQ(arr.length(), 0);
-    EXPECT_LT(arr.memory(), 3 * sizeof(Node<int>));
+    EXPECT_EQ(arr.memory(), 0);
+    arr.append(40);
+    EXPECT_EQ(arr.at(0), 40);
+
+    myArray<int, FlatStorage> kept(values, 3);
+    kept.clear(false);
+    EXPECT_GE(kept.memory(), 3);
 }
 
 TEST(MyArrayTest, SortNumbers)
@@ -328,13 +340,13 @@ TEST(MyArrayTest, MemoryManagementTests)
     testArray.append(1);
     testArray.clear();
     EXPECT_EQ(testArray.length(), 0);
-    EXPECT_EQ(testArray.memory(), 10);
+    EXPECT_EQ(testArray.memory(), 0);
 
     for(int i = 0; i < 11; ++i)
         testArray.append(1);
     testArray.clear(false);
     EXPECT_EQ(testArray.length(), 0);
-    EXPECT_GT(testArray.memory(), 10);
+    EXPECT_GE(testArray.memory(), 11);
 }
 
 auto square = [](int in){return in * in; };
@@ -444,4 +456,1262 @@ TEST(MyArrayTest, Plus)
     myArray<int> testArray2(nums, 4);
     myArray<int> result = (testArray + testArray2);
     EXPECT_EQ(result.countIf(isEven), 5);
-}
\ No newline at end of file
+}
+
+TEST(MyArrayTest, FlatStorageBasics)
+{
+    int values[] = {4, 9, 2, 7};
+    myArray<int, FlatStorage> testArray(values, 4);
+    testArray.append(5);
+
+    EXPECT_EQ(testArray.length(), 5);
+    EXPECT_EQ(testArray.front(), 4);
+    EXPECT_EQ(testArray.back(), 5);
+    EXPECT_EQ(testArray.min(), 2);
+    EXPECT_EQ(testArray.max(), 9);
+    EXPECT_TRUE(testArray.in(7));
+    EXPECT_FALSE(testArray.in(8));
+    EXPECT_EQ(testArray.countIf(isEven), 2);
+
+    testArray[0] = 10;
+    EXPECT_EQ(testArray.at(0), 10);
+}
+
+TEST(MyArrayTest, FlatStorageGrowth)
+{
+    myArray<char, FlatStorage> testArray;
+    for(int i = 0; i < 1000; ++i)
+        testArray.append("ACGT"[i % 4]);
+    EXPECT_EQ(testArray.length(), 1000);
+    EXPECT_EQ(testArray.count('G'), 250);
+    EXPECT_EQ(testArray.at(-1), 'T');
+}
+
+TEST(MyArrayTest, EmptyFrontBackThrow)
+{
+    myArray<int> testArray;
+    EXPECT_THROW(testArray.front(), std::out_of_range);
+    EXPECT_THROW(testArray.back(), std::out_of_range);
+}
+
+TEST(MyArrayTest, ReserveAndShrinkToFit)
+{
+    myArray<int, FlatStorage> testArray;
+    testArray.reserve(1000);
+    EXPECT_EQ(testArray.memory(), 1000);
+    for(int i = 0; i < 1000; ++i)
+        testArray.append(i);
+    EXPECT_EQ(testArray.memory(), 1000);
+    EXPECT_EQ(testArray.at(999), 999);
+
+    testArray.pop();
+    testArray.shrink_to_fit();
+    EXPECT_EQ(testArray.memory(), 999);
+    EXPECT_EQ(testArray.at(998), 998);
+}
+
+TEST(MyArrayTest, GrowthFactor)
+{
+    myArray<int> testArray;
+    testArray.setGrowthFactor(1.5);
+    EXPECT_DOUBLE_EQ(testArray.growthFactor(), 1.5);
+    for(int i = 0; i < 11; ++i)
+        testArray.append(i);
+    EXPECT_EQ(testArray.memory(), 15);
+    EXPECT_THROW(testArray.setGrowthFactor(1.0), std::invalid_argument);
+}
+
+TEST(MyArrayTest, LinksSurviveReallocation)
+{
+    myArray<std::string> testArray;
+    for(int i = 0; i < 100; ++i)
+        testArray.append(std::to_string(i));
+    auto node = *testArray[0];
+    for(int i = 1; i < 100; ++i)
+        node = node->get_next();
+    EXPECT_EQ(node->get_data(), "99");
+    EXPECT_EQ(node->get_next(), nullptr);
+    EXPECT_EQ(testArray[50].get_previous()->get_data(), "49");
+}
+
+TEST(MyArrayTest, PmrArrayUsesArena)
+{
+    std::byte arena[4096];
+    std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena), std::pmr::null_memory_resource());
+    pmrArray<int, FlatStorage> testArray(&resource);
+    for(int i = 0; i < 100; ++i)
+        testArray.append(i);
+    EXPECT_EQ(testArray.length(), 100);
+    EXPECT_EQ(testArray.at(99), 99);
+    EXPECT_EQ(testArray.get_allocator().resource(), &resource);
+
+    pmrArray<int, FlatStorage> copied = testArray.copy();
+    EXPECT_EQ(copied.get_allocator().resource(), &resource);
+    EXPECT_EQ(copied.at(50), 50);
+}
+
+TEST(MyArrayTest, SubarrayAcrossAllocators)
+{
+    std::pmr::monotonic_buffer_resource resource;
+    myArray<char, FlatStorage> haystack("GATTACA", 7);
+    pmrArray<char, FlatStorage> needle("TAC", 3, &resource);
+    EXPECT_EQ(haystack.subarrayIndex(needle), 3);
+    EXPECT_TRUE(haystack.isSubarray(needle));
+}
+
+TEST(MyArrayTest, MoveStealsBuffer)
+{
+    myArray<int, FlatStorage> original;
+    for(int i = 0; i < 50; ++i)
+        original.append(i);
+    int *storage = &original[0];
+
+    myArray<int, FlatStorage> moved(std::move(original));
+    EXPECT_EQ(&moved[0], storage);
+    EXPECT_EQ(moved.length(), 50);
+    EXPECT_EQ(original.length(), 0);
+
+    myArray<int, FlatStorage> assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(&assigned[0], storage);
+    EXPECT_EQ(assigned.at(49), 49);
+
+    original.append(7);
+    EXPECT_EQ(original.at(0), 7);
+    EXPECT_TRUE(std::is_nothrow_move_constructible_v<myArray<std::string>>);
+    EXPECT_TRUE(std::is_nothrow_move_assignable_v<myArray<std::string>>);
+}
+
+TEST(MyArrayTest, LinkedMoveKeepsLinks)
+{
+    myArray<int> original;
+    for(int i = 0; i < 20; ++i)
+        original.append(i);
+    myArray<int> moved(std::move(original));
+    EXPECT_EQ(moved[0].get_next()->get_data(), 1);
+    EXPECT_EQ(moved[-1].get_previous()->get_data(), 18);
+}
+
+TEST(MyArrayTest, EmplaceAndMoveOnlyElements)
+{
+    myArray<std::unique_ptr<int>, FlatStorage> pointers;
+    for(int i = 0; i < 25; ++i)
+        pointers.emplace_back(new int(i));
+    pointers.append(std::make_unique<int>(25));
+    EXPECT_EQ(pointers.length(), 26);
+    EXPECT_EQ(*pointers[25], 25);
+    EXPECT_EQ(*pointers[3], 3);
+
+    myArray<std::pair<size_t, size_t>> orfs;
+    auto &added = orfs.emplace_back(3, 12);
+    EXPECT_EQ(added.second, 12);
+    EXPECT_EQ(orfs.at(0).first, 3);
+}
+
+template <typename Array>
+bool isSorted(const Array &testArray, bool reverse = false)
+{
+    for(size_t i = 1; i < testArray.length(); ++i)
+        if(reverse ? testArray.at(i - 1) < testArray.at(i) : testArray.at(i) < testArray.at(i - 1))
+            return false;
+    return true;
+}
+
+TEST(MyArrayTest, SortLargeInputs)
+{
+    std::srand(7);
+    myArray<int, FlatStorage> random, ascending, descending, equal, organPipe;
+    for(int i = 0; i < 20000; ++i)
+    {
+        random.append(std::rand() % 1000);
+        ascending.append(i);
+        descending.append(-i);
+        equal.append(5);
+        organPipe.append(i < 10000 ? i : 20000 - i);
+    }
+    for(auto *testArray : {&random, &ascending, &descending, &equal, &organPipe})
+    {
+        testArray->sort();
+        EXPECT_TRUE(isSorted(*testArray));
+        EXPECT_EQ(testArray->length(), 20000);
+    }
+    random.sort(true);
+    EXPECT_TRUE(isSorted(random, true));
+}
+
+TEST(MyArrayTest, SortWithComparatorAndProjection)
+{
+    myArray<std::pair<size_t, size_t>> orfs;
+    orfs.emplace_back(30, 1);
+    orfs.emplace_back(10, 3);
+    orfs.emplace_back(20, 2);
+
+    orfs.sort(std::greater<>());
+    EXPECT_EQ(orfs.at(0).first, 30);
+    EXPECT_EQ(orfs.at(2).first, 10);
+
+    orfs.sort(std::less<>(), &std::pair<size_t, size_t>::second);
+    EXPECT_EQ(orfs.at(0).first, 30);
+    EXPECT_EQ(orfs.at(1).first, 20);
+    EXPECT_EQ(orfs.at(2).first, 10);
+}
+
+TEST(MyArrayTest, StableSortKeepsOrderOfEqualKeys)
+{
+    myArray<std::pair<int, int>, FlatStorage> testArray;
+    for(int i = 0; i < 5000; ++i)
+        testArray.emplace_back(i % 7, i);
+    testArray.stable_sort(std::less<>(), [](const std::pair<int, int> &p) { return p.first; });
+    for(size_t i = 1; i < testArray.length(); ++i)
+    {
+        auto previous = testArray.at(i - 1), current = testArray.at(i);
+        EXPECT_TRUE(previous.first < current.first ||
+                    (previous.first == current.first && previous.second < current.second));
+    }
+}
+
+TEST(MyArrayTest, SortWithNonConstReferenceComparator)
+{
+    // comparators that take their arguments by non-const reference work with std::sort, so they must work here
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    auto byFirst = [](auto &a, auto &b) { return a.first < b.first; };
+    myArray<std::pair<int, int>, FlatStorage> stable, parallel;
+    for(int i = 0; i < 5000; ++i)
+    {
+        stable.emplace_back((i * 7919) % 13, i);
+        parallel.emplace_back((i * 7919) % 5003, i);
+    }
+    stable.stable_sort(byFirst);
+    parallel.sort(byFirst);
+    for(size_t i = 1; i < stable.length(); ++i)
+    {
+        auto previous = stable.at(i - 1), current = stable.at(i);
+        EXPECT_TRUE(previous.first < current.first ||
+                    (previous.first == current.first && previous.second < current.second));
+        EXPECT_LE(parallel.at(i - 1).first, parallel.at(i).first);
+    }
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyArrayTest, StableSortKeepsOrderOfEqualFloats)
+{
+    // -0.0 and 0.0 compare equal, so a stable sort has to leave them in their original order
+    std::vector<double> values;
+    for(int i = 0; i < 1000; ++i)
+        values.push_back(i % 3 == 0 ? (i % 2 ? -0.0 : 0.0) : static_cast<double>(i % 11 - 5));
+    for(bool reverse : {false, true})
+    {
+        myArray<double, FlatStorage> testArray;
+        for(double value: values)
+            testArray.append(value);
+        testArray.stable_sort(reverse);
+        std::vector<double> expected = values;
+        if(reverse)
+            std::stable_sort(expected.begin(), expected.end(), std::greater<>());
+        else
+            std::stable_sort(expected.begin(), expected.end());
+        for(size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(testArray.at(i), expected[i]);
+            EXPECT_EQ(std::signbit(testArray.at(i)), std::signbit(expected[i]));
+        }
+    }
+}
+
+TEST(MyArrayTest, ParallelSort)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    std::srand(11);
+    myArray<std::pair<int, int>, FlatStorage> pairs;
+    myArray<std::string> words;
+    for(int i = 0; i < 50000; ++i)
+    {
+        pairs.emplace_back(std::rand() % 100, i);
+        words.append(std::to_string(std::rand()));
+    }
+    pairs.sort(std::less<>(), [](const std::pair<int, int> &p) { return p.first; });
+    words.sort();
+    EXPECT_TRUE(isSorted(words));
+    for(size_t i = 1; i < pairs.length(); ++i)
+        EXPECT_TRUE(pairs.at(i - 1).first < pairs.at(i).first ||
+                    (pairs.at(i - 1).first == pairs.at(i).first && pairs.at(i - 1).second < pairs.at(i).second));
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+template <typename T>
+void expectMatchesStdSort(std::vector<T> values, bool reverse)
+{
+    myArray<T, FlatStorage> testArray(values.data(), values.size());
+    testArray.sort(reverse);
+    if(reverse)
+        std::sort(values.begin(), values.end(), std::greater<T>());
+    else
+        std::sort(values.begin(), values.end());
+    ASSERT_EQ(testArray.length(), values.size());
+    for(size_t i = 0; i < values.size(); ++i)
+        ASSERT_EQ(testArray.at(i), values[i]);
+}
+
+TEST(MyArrayTest, CountingAndRadixSort)
+{
+    std::srand(3);
+    std::vector<char> bases;
+    std::vector<signed char> bytes;
+    std::vector<short> shorts;
+    std::vector<int> ints;
+    std::vector<unsigned long long> longs;
+    std::vector<double> doubles;
+    std::vector<float> floats;
+    for(int i = 0; i < 3000; ++i)
+    {
+        bases.push_back("ACGTN"[std::rand() % 5]);
+        bytes.push_back(static_cast<signed char>(std::rand() % 256 - 128));
+        shorts.push_back(static_cast<short>(std::rand() % 65536 - 32768));
+        ints.push_back(std::rand() - RAND_MAX / 2);
+        longs.push_back((static_cast<unsigned long long>(std::rand()) << 33) ^ std::rand());
+        doubles.push_back((std::rand() - RAND_MAX / 2) / 1024.0);
+        floats.push_back(static_cast<float>(std::rand() % 2000 - 1000) * 0.25f);
+    }
+    for(bool reverse : {false, true})
+    {
+        expectMatchesStdSort(bases, reverse);
+        expectMatchesStdSort(bytes, reverse);
+        expectMatchesStdSort(shorts, reverse);
+        expectMatchesStdSort(ints, reverse);
+        expectMatchesStdSort(longs, reverse);
+        expectMatchesStdSort(doubles, reverse);
+        expectMatchesStdSort(floats, reverse);
+    }
+}
+
+TEST(MyArrayTest, RadixSortLinkedStorage)
+{
+    myArray<int> testArray;
+    for(int i = 0; i < 1000; ++i)
+        testArray.append((i * 7919) % 1000 - 500);
+    testArray.sort();
+    EXPECT_TRUE(isSorted(testArray));
+    EXPECT_EQ(testArray.front(), -500);
+    EXPECT_EQ(testArray[1].get_previous()->get_data(), -500);
+}
+
+template <typename T>
+void expectSearchKernelsMatch(const std::vector<T> &values, T needle)
+{
+    size_t first = std::find(values.begin(), values.end(), needle) - values.begin();
+    size_t total = std::count(values.begin(), values.end(), needle);
+    EXPECT_EQ(arraySimd::find(values.data(), values.size(), needle), first);
+    EXPECT_EQ(arraySimd::count(values.data(), values.size(), needle), total);
+#ifdef MYARRAY_X86_SIMD
+    if(arraySimd::cpu().avx2)
+    {
+        EXPECT_EQ(arraySimd::findAvx2(values.data(), values.size(), needle), first);
+        EXPECT_EQ(arraySimd::countAvx2(values.data(), values.size(), needle), total);
+    }
+    if constexpr (arraySimd::sse2Vectorizable<T>)
+    {
+        EXPECT_EQ(arraySimd::findSse2(values.data(), values.size(), needle), first);
+        EXPECT_EQ(arraySimd::countSse2(values.data(), values.size(), needle), total);
+    }
+#endif
+}
+
+TEST(MyArrayTest, VectorSearchKernels)
+{
+    for(size_t n : {0, 1, 15, 31, 32, 33, 100, 1027})
+    {
+        std::vector<char> bases;
+        std::vector<short> shorts;
+        std::vector<int> ints;
+        std::vector<long long> longs;
+        std::vector<float> floats;
+        std::vector<double> doubles;
+        for(size_t i = 0; i < n; ++i)
+        {
+            bases.push_back("ACGT"[(i * 7) % 4]);
+            shorts.push_back(static_cast<short>(i % 9));
+            ints.push_back(static_cast<int>(i % 13) - 6);
+            longs.push_back(static_cast<long long>(i % 5) << 40);
+            floats.push_back(static_cast<float>(i % 6) * 0.5f);
+            doubles.push_back(static_cast<double>(i % 11) - 0.25);
+        }
+        expectSearchKernelsMatch(bases, 'G');
+        expectSearchKernelsMatch(bases, 'N');
+        expectSearchKernelsMatch(shorts, short(8));
+        expectSearchKernelsMatch(ints, -6);
+        expectSearchKernelsMatch(longs, 3LL << 40);
+        expectSearchKernelsMatch(floats, 2.5f);
+        expectSearchKernelsMatch(doubles, 9.75);
+    }
+}
+
+TEST(MyArrayTest, VectorSearchThroughMyArray)
+{
+    myArray<char, FlatStorage> sequence;
+    for(int i = 0; i < 1000; ++i)
+        sequence.append(i == 700 ? 'N' : "ACGT"[i % 4]);
+    EXPECT_EQ(sequence.count('G'), 250);
+    EXPECT_EQ(sequence.index('N'), 700);
+    EXPECT_EQ(sequence.index('A', 701), 704);
+    EXPECT_THROW(sequence.index('N', 701), std::out_of_range);
+    EXPECT_THROW(sequence.index('A', 5000), std::out_of_range);
+    EXPECT_TRUE(sequence.in('N'));
+    EXPECT_FALSE(sequence.in('U'));
+}
+
+TEST(MyArrayTest, ReductionKernels)
+{
+    for(size_t n : {1, 7, 31, 32, 33, 100, 1027})
+    {
+        std::vector<signed char> bytes;
+        std::vector<unsigned short> shorts;
+        std::vector<int> ints;
+        std::vector<long long> longs;
+        std::vector<float> floats;
+        for(size_t i = 0; i < n; ++i)
+        {
+            bytes.push_back(static_cast<signed char>((i * 37) % 200 - 100));
+            shorts.push_back(static_cast<unsigned short>((i * 7919) % 60000));
+            ints.push_back(static_cast<int>((i * 104729) % 2001) - 1000);
+            longs.push_back(static_cast<long long>(i % 17) << 35);
+            floats.push_back(static_cast<float>(i % 8) * 0.25f);
+        }
+        EXPECT_EQ(arraySimd::sum(bytes.data(), n), arraySimd::sumScalar(bytes.data(), n));
+        EXPECT_EQ(arraySimd::sum(ints.data(), n), arraySimd::sumScalar(ints.data(), n));
+        EXPECT_EQ(arraySimd::sum(longs.data(), n), arraySimd::sumScalar(longs.data(), n));
+        EXPECT_EQ(arraySimd::sum(floats.data(), n), arraySimd::sumScalar(floats.data(), n));
+        EXPECT_EQ(arraySimd::minmax(bytes.data(), n), arraySimd::minmaxScalar(bytes.data(), n));
+        EXPECT_EQ(arraySimd::minmax(shorts.data(), n), arraySimd::minmaxScalar(shorts.data(), n));
+        EXPECT_EQ(arraySimd::minmax(ints.data(), n), arraySimd::minmaxScalar(ints.data(), n));
+        EXPECT_EQ(arraySimd::minmax(longs.data(), n), arraySimd::minmaxScalar(longs.data(), n));
+        EXPECT_EQ(arraySimd::minmax(floats.data(), n), arraySimd::minmaxScalar(floats.data(), n));
+    }
+}
+
+TEST(MyArrayTest, SumMinMax)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    myArray<int, FlatStorage> flat;
+    myArray<int> linked;
+    for(int i = 0; i < 20000; ++i)
+    {
+        int element = (i * 7919) % 20011 - 10000;
+        flat.append(element);
+        linked.append(element);
+    }
+    EXPECT_EQ(flat.sum(), linked.sum());
+    EXPECT_EQ(flat.minmax(), linked.minmax());
+    EXPECT_EQ(flat.min(), linked.min());
+    EXPECT_EQ(flat.max(), linked.max());
+
+    // 1 + 1e-16 * 10000 is out of reach for a plain running double sum
+    myArray<double, FlatStorage> tiny;
+    tiny.append(1.0);
+    for(int i = 0; i < 10000; ++i)
+        tiny.append(1e-16);
+    EXPECT_DOUBLE_EQ(tiny.sum(true), 1.000000000001);
+    myArray<double> tinyLinked;
+    tinyLinked.append(1.0);
+    for(int i = 0; i < 10000; ++i)
+        tinyLinked.append(1e-16);
+    EXPECT_EQ(tinyLinked.sum(true), tiny.sum(true));
+
+    myArray<std::string> words;
+    words.append("a");
+    words.append("b");
+    EXPECT_EQ(words.sum(), "ab");
+    EXPECT_EQ(words.minmax(), std::make_pair(std::string("a"), std::string("b")));
+    EXPECT_THROW(myArray<int>().minmax(), std::out_of_range);
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyArrayTest, VectoriseWithCapturesAndPolicies)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    myArray<int, FlatStorage> qualities;
+    for(int i = 0; i < 10000; ++i)
+        qualities.append(i % 42);
+    int offset = 33;
+    qualities.vectorise([offset](int quality) { return quality + offset; });
+    EXPECT_EQ(qualities.at(41), 74);
+    qualities.vectorise(arrayParallel::par, [](int quality) { return std::min(quality, 60); });
+    qualities.vectorise(arrayParallel::par_unseq, [offset](int quality) { return quality - offset; });
+    EXPECT_EQ(qualities.max(), 27);
+    EXPECT_EQ(qualities.at(10), 10);
+
+    // the std::execution policies work the same once myArray_execution.h is included
+    qualities.vectorise(std::execution::par, [offset](int quality) { return quality + offset; });
+    qualities.vectorise(std::execution::seq, [](int quality) { return quality * 2; });
+    EXPECT_EQ(qualities.at(10), 86);
+    EXPECT_EQ(qualities.countIf(std::execution::par_unseq, [](int quality) { return quality == 86; }),
+              qualities.countIf(arrayParallel::seq, [](int quality) { return quality == 86; }));
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyArrayTest, MapToOtherTypes)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    myArray<int> numbers;
+    for(int i = 0; i < 5000; ++i)
+        numbers.append(i);
+    myArray<std::string> words = numbers.map([](int n) { return std::to_string(n); });
+    EXPECT_EQ(words.length(), 5000);
+    EXPECT_EQ(words.at(4321), "4321");
+    EXPECT_EQ(words[1].get_previous()->get_data(), "0");
+    auto halves = numbers.map<double>(arrayParallel::par, [](int n) { return n / 2; });
+    EXPECT_DOUBLE_EQ(halves.at(7), 3.0);
+    myArray<char, FlatStorage> bases("ACGTN", 5);
+    auto masked = bases.map(arrayParallel::par, [](char base) { return base == 'N' ? 'N' : char(base + 32); });
+    EXPECT_EQ(masked.str(""), "acgtN");
+
+    EXPECT_THROW(numbers.map(arrayParallel::par, [](int n) {
+        if(n == 4000) throw std::runtime_error("bad element");
+        return std::to_string(n);
+    }), std::runtime_error);
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyArrayTest, PredicatesWithCapturesAndPolicies)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    myArray<int, FlatStorage> numbers;
+    for(int i = 0; i < 10000; ++i)
+        numbers.append(i);
+    int limit = 2500;
+    auto below = [&limit](int n) { return n < limit; };
+    EXPECT_EQ(numbers.countIf(below), 2500);
+    EXPECT_EQ(numbers.countIf(arrayParallel::par, below), 2500);
+    EXPECT_EQ(numbers.countIf(arrayParallel::par, isEven), 5000);
+    EXPECT_TRUE(numbers.anyOf(below));
+    EXPECT_TRUE(numbers.anyOf(arrayParallel::par, [](int n) { return n == 9999; }));
+    EXPECT_FALSE(numbers.anyOf(arrayParallel::par, [](int n) { return n < 0; }));
+    EXPECT_TRUE(numbers.allOf(arrayParallel::par, [](int n) { return n >= 0; }));
+    EXPECT_FALSE(numbers.allOf(below));
+    EXPECT_FALSE(numbers.allOf(arrayParallel::par, [](int n) { return n != 7000; }));
+    EXPECT_TRUE(numbers.noneOf(arrayParallel::par, [](int n) { return n > 10000; }));
+    EXPECT_FALSE(numbers.noneOf(isEven));
+
+    // the sequential versions stop at the first decisive element
+    size_t calls = 0;
+    EXPECT_TRUE(numbers.anyOf([&calls](int n) { ++calls; return n == 3; }));
+    EXPECT_EQ(calls, 4);
+
+    myArray<int> empty;
+    EXPECT_FALSE(empty.anyOf(isEven));
+    EXPECT_TRUE(empty.allOf(isEven));
+    EXPECT_TRUE(empty.noneOf(isEven));
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyArrayTest, SliceViews)
+{
+    int values[] = {1, 2, 3, 4, 5, 6, 7};
+    myArray<int> linked(values, 7);
+    myArray<int, FlatStorage> flat(values, 7);
+
+    auto odd = flat.slice(0, 6, 2);
+    EXPECT_EQ(odd.length(), 4);
+    EXPECT_EQ(odd[3], 7);
+    EXPECT_EQ(odd.at(-1), 7);
+    EXPECT_THROW(odd.at(4), std::out_of_range);
+    EXPECT_EQ(odd.sum(), 16);
+    EXPECT_EQ(odd.minmax(), std::make_pair(1, 7));
+    EXPECT_EQ(odd.countIf(isEven), 0);
+
+    auto backwards = linked.slice(1, 5, -2);
+    EXPECT_EQ(backwards.length(), 3);
+    EXPECT_EQ(backwards[0], 6);
+    EXPECT_EQ(backwards[2], 2);
+    std::vector<int> seen(backwards.begin(), backwards.end());
+    EXPECT_EQ(seen, std::vector<int>({6, 4, 2}));
+    EXPECT_TRUE(std::ranges::random_access_range<decltype(backwards)>);
+
+    // the view reads through to the array, and only materialize() copies
+    auto middle = flat.slice(2, 4);
+    EXPECT_EQ(middle.sum(), 12);
+    EXPECT_EQ(middle.countOf(4), 1);
+    myArray<int, FlatStorage> copied = middle.materialize();
+    flat[3] = 40;
+    EXPECT_EQ(middle[1], 40);
+    EXPECT_EQ(copied.at(1), 4);
+
+    int palindrome[] = {1, 2, 3, 2, 1};
+    myArray<int> mirrored(palindrome, 5);
+    EXPECT_TRUE(mirrored.slice(0, 4, -1) == mirrored);
+    EXPECT_TRUE(mirrored == mirrored.slice(0, 4, -1));
+    EXPECT_FALSE(linked.slice(0, 6, -1) == linked);
+    EXPECT_TRUE(linked.slice(0, 2) == flat.slice(0, 2));
+    EXPECT_FALSE(linked.slice(0, 3) == flat.slice(0, 3));
+
+    EXPECT_THROW(flat.slice(3, 2), std::out_of_range);
+    EXPECT_THROW(flat.slice(0, 7), std::out_of_range);
+    EXPECT_THROW(flat.slice(0, 1, 0), std::out_of_range);
+}
+
+TEST(MyArrayTest, IteratorsAndRanges)
+{
+    static_assert(std::contiguous_iterator<myArray<int, FlatStorage>::iterator>);
+    static_assert(std::ranges::contiguous_range<myArray<char, FlatStorage>>);
+    static_assert(std::random_access_iterator<myArray<int>::iterator>);
+    static_assert(std::random_access_iterator<myArray<int>::const_iterator>);
+    static_assert(std::ranges::random_access_range<const myArray<std::string>>);
+    static_assert(std::ranges::sized_range<myArray<int>>);
+
+    int values[] = {5, 3, 9, 1, 7};
+    myArray<int> linked(values, 5);
+    myArray<int, FlatStorage> flat(values, 5);
+    EXPECT_EQ(flat.data()[2], 9);
+    EXPECT_EQ(std::ranges::size(linked), 5);
+
+    std::ranges::sort(linked);
+    std::sort(flat.begin(), flat.end());
+    for(size_t i = 0; i < 5; ++i)
+        EXPECT_EQ(linked.at(i), flat.at(i));
+    // sorting through the iterators moves the elements, the node links stay in place
+    EXPECT_EQ(linked[1].get_previous()->get_data(), 1);
+
+    int total = 0;
+    for(int &element: linked)
+        total += element;
+    EXPECT_EQ(total, 25);
+    EXPECT_EQ(std::transform_reduce(flat.begin(), flat.end(), 0, std::plus<>(), square), 165);
+    EXPECT_EQ(*std::ranges::max_element(linked), 9);
+    EXPECT_EQ(*linked.rbegin(), 9);
+    myArray<int>::const_iterator first = linked.begin();
+    EXPECT_TRUE(first == linked.cbegin());
+    EXPECT_EQ(linked.cend() - first, 5);
+    std::vector<int> reversed(flat.rbegin(), flat.rend());
+    EXPECT_EQ(reversed, std::vector<int>({9, 7, 5, 3, 1}));
+
+    myArray<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(MyArrayTest, UncheckedAccess)
+{
+    int values[] = {4, 8, 15};
+    myArray<int> linked(values, 3);
+    myArray<int, FlatStorage> flat(values, 3);
+    linked(1) = 16;
+    flat(2) += 1;
+    EXPECT_EQ(linked(1), 16);
+    EXPECT_EQ(flat(2), 16);
+    const auto &constant = flat;
+    EXPECT_EQ(&constant(0), flat.data());
+    EXPECT_EQ(&constant.at(-1), &flat(2));
+#ifdef MYARRAY_CHECKED
+    EXPECT_THROW(linked(3), std::out_of_range);
+    EXPECT_THROW(constant(5), std::out_of_range);
+#endif
+}
+
+TEST(MyArrayTest, RangeInsertAndErase)
+{
+    int values[] = {1, 2, 3, 4, 5};
+    myArray<int> linked(values, 5);
+    myArray<int, FlatStorage> flat(values, 5);
+    std::vector<int> extra = {10, 11, 12};
+
+    linked.insert(7, 0);
+    EXPECT_EQ(linked.at(0), 7);
+    EXPECT_EQ(linked.at(1), 1);
+    linked.pop(0);
+
+    linked.insert(2, extra.begin(), extra.end());
+    flat.insert(2, extra.begin(), extra.end());
+    linked.insert(8, 2, 0);
+    flat.insert(8, 2, 0);
+    std::vector<int> expected = {1, 2, 10, 11, 12, 3, 4, 5, 0, 0};
+    EXPECT_EQ(std::vector<int>(linked.begin(), linked.end()), expected);
+    EXPECT_EQ(std::vector<int>(flat.begin(), flat.end()), expected);
+    EXPECT_EQ(linked[3].get_previous()->get_data(), 10);
+    EXPECT_EQ(linked[7].get_next()->get_data(), 0);
+
+    linked.erase(1, 4);
+    flat.erase(1, 4);
+    linked.erase(4, 100);
+    flat.erase(4, 100);
+    expected = {1, 3, 4, 5};
+    EXPECT_EQ(std::vector<int>(linked.begin(), linked.end()), expected);
+    EXPECT_EQ(std::vector<int>(flat.begin(), flat.end()), expected);
+    EXPECT_EQ(linked[3].get_next(), nullptr);
+    EXPECT_EQ(linked[1].get_previous()->get_data(), 1);
+    EXPECT_THROW(flat.insert(5, 1, 9), std::out_of_range);
+    EXPECT_THROW(flat.erase(5), std::out_of_range);
+
+    myArray<std::string> words;
+    words.append("c");
+    std::vector<std::string> front = {"a", "b"};
+    words.insert(0, front.begin(), front.end());
+    words.insert(3, 1, words.at(0));
+    EXPECT_EQ(words.str(""), "abca");
+    words.erase(0, 2);
+    EXPECT_EQ(words.str(""), "ca");
+}
+
+TEST(MyArrayTest, InsertRangeFromItself)
+{
+    int values[] = {1, 2, 3, 4, 5};
+    std::vector<int> doubled = {1, 2, 3, 4, 5, 1, 2, 3, 4, 5};
+    myArray<int> linked(values, 5);
+    myArray<int, FlatStorage> flat(values, 5);
+    myArray<int, GapStorage> gapped(values, 5);
+    myArray<int, SmallStorage<8>> small(values, 5);
+    linked.insert(0, linked.begin(), linked.end());
+    flat.insert(0, flat.begin(), flat.end());
+    gapped.insert(0, gapped.begin(), gapped.end());
+    small.insert(0, small.begin(), small.end());
+    EXPECT_EQ(std::vector<int>(linked.begin(), linked.end()), doubled);
+    EXPECT_EQ(std::vector<int>(flat.begin(), flat.end()), doubled);
+    EXPECT_EQ(std::vector<int>(gapped.begin(), gapped.end()), doubled);
+    EXPECT_EQ(std::vector<int>(small.begin(), small.end()), doubled);
+
+    // a part of the array that the shift moves, without a reallocation
+    myArray<std::string, FlatStorage> words;
+    words.reserve(10);
+    for(const char *word: {"a", "b", "c", "d"})
+        words.append(word);
+    words.insert(1, words.begin() + 1, words.begin() + 3);
+    EXPECT_EQ(words.str(""), "abcbcd");
+}
+
+TEST(MyArrayTest, GapStorageEdits)
+{
+    int values[] = {1, 2, 3, 4, 5, 6};
+    myArray<int, GapStorage> gap(values, 6);
+    std::vector<int> reference(values, values + 6);
+    auto expectSame = [&]() {
+        ASSERT_EQ(gap.length(), reference.size());
+        for(size_t i = 0; i < reference.size(); ++i)
+            ASSERT_EQ(gap.at(i), reference[i]);
+        EXPECT_TRUE(std::equal(gap.begin(), gap.end(), reference.begin(), reference.end()));
+    };
+
+    // a run of edits around a moving cursor, like a mutation simulation
+    std::srand(5);
+    size_t cursor = 3;
+    for(int step = 0; step < 2000; ++step)
+    {
+        cursor = std::min<size_t>(reference.size(), cursor + std::rand() % 5);
+        if(std::rand() % 8 == 0)
+            cursor = std::rand() % (reference.size() + 1);
+        int action = std::rand() % 3;
+        if(action == 0 || reference.size() < 4)
+        {
+            std::vector<int> bases = {step, step + 1};
+            gap.insert(cursor, bases.begin(), bases.end());
+            reference.insert(reference.begin() + cursor, bases.begin(), bases.end());
+        }
+        else if(action == 1 && cursor < reference.size())
+        {
+            size_t count = std::min<size_t>(3, reference.size() - cursor);
+            gap.erase(cursor, 3);
+            reference.erase(reference.begin() + cursor, reference.begin() + cursor + count);
+        }
+        else if(cursor < reference.size())
+        {
+            gap[cursor] = -step;
+            reference[cursor] = -step;
+        }
+    }
+    expectSame();
+
+    // every other operation sees the same logical sequence wherever the gap is
+    gap.insert(gap.length() / 2, 1, 42);
+    reference.insert(reference.begin() + reference.size() / 2, 42);
+    EXPECT_EQ(gap.count(42), std::count(reference.begin(), reference.end(), 42));
+    EXPECT_EQ(gap.sum(), std::accumulate(reference.begin(), reference.end(), 0));
+    myArray<int, GapStorage> copied(gap);
+    EXPECT_TRUE(copied == gap);
+    gap.append(7);
+    reference.push_back(7);
+    expectSame();
+    gap.insert(1, 2, 9);
+    reference.insert(reference.begin() + 1, 2, 9);
+    EXPECT_EQ(gap.pop(1), 9);
+    reference.erase(reference.begin() + 1);
+    gap.sort();
+    std::sort(reference.begin(), reference.end());
+    expectSame();
+
+    myArray<std::string, GapStorage> words;
+    words.append("b");
+    words.insert(0, 1, "a");
+    words.insert(2, 1, "d");
+    words.insert(2, 1, "c");
+    words.erase(0);
+    EXPECT_EQ(words.str(""), "bcd");
+    static_assert(std::random_access_iterator<myArray<std::string, GapStorage>::iterator>);
+}
+
+TEST(MyArrayTest, SharedStorageCopyOnWrite)
+{
+    int values[] = {3, 1, 4, 1, 5, 9, 2, 6};
+    myArray<int, SharedStorage> original(values, 8);
+    const auto &view = original;
+
+    // copies share the buffer until one of them is modified
+    myArray<int, SharedStorage> copied(original);
+    myArray<int, SharedStorage> viaCopy = original.copy();
+    myArray<int, SharedStorage> assigned;
+    assigned = original;
+    EXPECT_EQ(original.useCount(), 4);
+    EXPECT_EQ(std::as_const(copied).data(), view.data());
+    EXPECT_EQ(std::as_const(assigned).data(), view.data());
+
+    copied(0) = 30;
+    EXPECT_EQ(original.useCount(), 3);
+    EXPECT_EQ(copied.useCount(), 1);
+    EXPECT_NE(std::as_const(copied).data(), view.data());
+    EXPECT_EQ(copied.at(0), 30);
+    EXPECT_EQ(original.at(0), 3);
+
+    viaCopy.sort();
+    assigned.append(7);
+    EXPECT_EQ(viaCopy.str(""), "11234569");
+    EXPECT_EQ(assigned.length(), 9);
+    EXPECT_EQ(original.str(""), "31415926");
+    EXPECT_EQ(original.useCount(), 1);
+
+    // combining arrays copies the shared elements once, into a buffer big enough for both
+    myArray<int, SharedStorage> other(original);
+    myArray<int, SharedStorage> joined = original + other;
+    EXPECT_EQ(joined.length(), 16);
+    EXPECT_EQ(original.useCount(), 2);
+    other.clear();
+    EXPECT_EQ(original.useCount(), 1);
+    EXPECT_EQ(original.length(), 8);
+
+    // moving transfers the reference, destroying the last owner frees the elements
+    myArray<std::string, SharedStorage> words;
+    words.append("reference");
+    {
+        myArray<std::string, SharedStorage> workers[4] = {words, words, words, words};
+        EXPECT_EQ(words.useCount(), 5);
+        myArray<std::string, SharedStorage> moved(std::move(workers[0]));
+        EXPECT_EQ(words.useCount(), 5);
+        *moved.begin() += " edited";
+        EXPECT_EQ(moved.at(0), "reference edited");
+        EXPECT_EQ(words.useCount(), 4);
+    }
+    EXPECT_EQ(words.useCount(), 1);
+    EXPECT_EQ(words.at(0), "reference");
+}
+
+TEST(MyArrayTest, SmallStorageInlineBuffer)
+{
+    auto isInline = [](const auto &array) {
+        auto address = reinterpret_cast<const char *>(array.data());
+        auto object = reinterpret_cast<const char *>(&array);
+        return address >= object && address < object + sizeof(array);
+    };
+
+    myArray<char, SmallStorage<4>> codon("ATG", 3);
+    EXPECT_TRUE(isInline(codon));
+    EXPECT_EQ(codon.memory(), 4);
+    codon.append('C');
+    EXPECT_TRUE(isInline(codon));
+
+    // spills to the heap once the inline cells are full, and comes back when it fits again
+    codon.append('G');
+    EXPECT_FALSE(isInline(codon));
+    EXPECT_EQ(codon.str(""), "ATGCG");
+    codon.erase(1, 3);
+    codon.shrink_to_fit();
+    EXPECT_TRUE(isInline(codon));
+    EXPECT_EQ(codon.str(""), "AG");
+    EXPECT_EQ(codon.memory(), 4);
+
+    // copies and moves keep their own inline cells
+    myArray<char, SmallStorage<4>> copied(codon);
+    myArray<char, SmallStorage<4>> moved(std::move(copied));
+    EXPECT_TRUE(isInline(moved));
+    EXPECT_EQ(moved.str(""), "AG");
+    EXPECT_EQ(copied.length(), 0);
+    copied.append('T');
+    EXPECT_TRUE(isInline(copied));
+
+    myArray<std::string, SmallStorage<>> words;
+    EXPECT_TRUE(isInline(words));
+    for(int i = 0; i < 40; ++i)
+        words.append(std::string(30, char('a' + i % 26)));
+    EXPECT_FALSE(isInline(words));
+    myArray<std::string, SmallStorage<>> assigned;
+    assigned.append("short");
+    assigned = std::move(words);
+    EXPECT_EQ(assigned.length(), 40);
+    EXPECT_EQ(assigned.at(27), std::string(30, 'b'));
+    words = assigned.slice(0, 2);
+    words.sort();
+    EXPECT_TRUE(isInline(words));
+    EXPECT_EQ(words.at(0), std::string(30, 'a'));
+    myArray<std::string, SmallStorage<>> fromInline(std::move(words));
+    EXPECT_EQ(fromInline.length(), 3);
+}
+
+TEST(MyArrayTest, SmallStorageStartsInline)
+{
+    // fewer inline cells than a default array starts with must still hold the first elements without the heap
+    myArray<int, SmallStorage<4>> testArray;
+    auto object = reinterpret_cast<const char *>(&testArray);
+    for(int i = 0; i < 4; ++i)
+        testArray.append(i);
+    auto address = reinterpret_cast<const char *>(testArray.data());
+    EXPECT_TRUE(address >= object && address < object + sizeof(testArray));
+    EXPECT_EQ(testArray.memory(), 4);
+    EXPECT_EQ(testArray.str(), "0, 1, 2, 3");
+
+    int first = 7;
+    myArray<int, SmallStorage<4>> single(first);
+    EXPECT_EQ(single.memory(), 4);
+}
+
+TEST(MyArrayTest, CompiledPatterns)
+{
+    std::string text;
+    std::srand(17);
+    for(int i = 0; i < 20000; ++i)
+        text += "ACGT"[std::rand() % 4];
+    myArray<char, FlatStorage> flat(text.data(), text.size());
+    myArray<char> linked(text.data(), text.size());
+
+    // every algorithm agrees with std::search, on contiguous and linked haystacks
+    for(size_t m: {1, 3, 7, 8, 12, 20})
+    {
+        std::string motif = text.substr(12345, m);
+        Pattern<char> pattern(motif.data(), motif.size());
+        EXPECT_EQ(pattern.algorithm(), m >= Pattern<char>::horspoolMinimum ? Pattern<char>::Algorithm::Horspool
+                                                                             : Pattern<char>::Algorithm::Scan);
+        for(size_t from: {size_t(0), size_t(100), size_t(12345), size_t(12346), text.size() - m})
+        {
+            size_t expected = text.find(motif, from);
+            if(expected == std::string::npos)
+                expected = text.size();
+            EXPECT_EQ(pattern.find(flat.begin(), flat.end(), from), expected);
+            EXPECT_EQ(pattern.find(linked.begin(), linked.end(), from), expected);
+        }
+    }
+    Pattern<char> absent("AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA", 32);
+    EXPECT_FALSE(flat.isSubarray(absent));
+    EXPECT_THROW(flat.subarrayIndex(absent), std::out_of_range);
+    EXPECT_EQ(Pattern<char>(nullptr, 0).find(flat.begin(), flat.end(), 5), 5);
+
+    // other element types use KMP
+    int values[] = {1, 2, 1, 2, 1, 3, 1, 2, 1, 2, 1, 3};
+    myArray<int> numbers(values, 12);
+    int motif[] = {1, 2, 1, 3};
+    Pattern<int> pattern(motif, 4);
+    EXPECT_EQ(pattern.algorithm(), Pattern<int>::Algorithm::Kmp);
+    EXPECT_EQ(numbers.subarrayIndex(pattern), 2);
+    EXPECT_EQ(numbers.subarrayIndex(pattern, 3), 8);
+    EXPECT_EQ(numbers.subarrayIndex(myArray<int>(motif, 4), 3), 8);
+
+    // one compiled pattern serves several threads at once
+    Pattern<char> shared(text.substr(19000, 10));
+    std::vector<size_t> found(4);
+    arrayParallel::forChunks(4, 4, [&](size_t begin, size_t, unsigned chunk) {
+        found[chunk] = flat.subarrayIndex(shared, begin * 100);
+    });
+    for(size_t index: found)
+        EXPECT_EQ(index, text.find(text.substr(19000, 10)));
+}
+
+TEST(MyArrayTest, PatternSetMatches)
+{
+    std::string text(5000, 'A');
+    std::srand(21);
+    for(char &base: text)
+        base = "ACGT"[std::rand() % 4];
+    myArray<char, FlatStorage> flat(text.data(), text.size());
+    std::vector<std::string> motifs = {"ACG", "CG", "G", "TACGT", "ACG", "GGGG"};
+    PatternSet<char> set(motifs);
+    EXPECT_EQ(set.patterns(), 6);
+    EXPECT_EQ(set.alphabet(), 5);
+
+    // same matches as searching every pattern on its own, in order of their ends
+    std::vector<PatternSet<char>::Match> expected;
+    for(size_t id = 0; id < motifs.size(); ++id)
+        for(size_t pos = text.find(motifs[id]); pos != std::string::npos; pos = text.find(motifs[id], pos + 1))
+            expected.push_back({pos, id});
+    auto found = flat.matches(set);
+    auto byEnd = [&](const auto &a, const auto &b) {
+        return std::tuple(a.position + motifs[a.pattern].size(), a.pattern)
+             < std::tuple(b.position + motifs[b.pattern].size(), b.pattern);
+    };
+    std::sort(expected.begin(), expected.end(), byEnd);
+    std::sort(found.begin(), found.end(), byEnd);
+    EXPECT_EQ(found, expected);
+
+    // leftmost match and early exit
+    auto first = set.findFirst(flat.begin(), flat.end(), 100);
+    size_t leftmost = text.size();
+    for(const auto &motif: motifs)
+        leftmost = std::min(leftmost, text.find(motif, 100));
+    EXPECT_EQ(first.position, leftmost);
+    EXPECT_EQ(text.compare(first.position, motifs[first.pattern].size(), motifs[first.pattern]), 0);
+    EXPECT_EQ(set.findFirst(flat.begin(), flat.end(), text.size()).pattern, set.patterns());
+    size_t calls = 0;
+    flat.forEachMatch(set, [&](const PatternSet<char>::Match &) { return ++calls < 3; });
+    EXPECT_EQ(calls, 3);
+
+    // other element types and invalid sets
+    int values[] = {5, 1, 2, 1, 2, 3, 9, 1, 2, 3};
+    myArray<int> numbers(values, 10);
+    PatternSet<int> numeric(std::vector<std::vector<int>>{{1, 2, 3}, {2, 1}, {9}});
+    std::vector<PatternSet<int>::Match> numericExpected = {{2, 1}, {3, 0}, {6, 2}, {7, 0}};
+    EXPECT_EQ(numbers.matches(numeric), numericExpected);
+    EXPECT_THROW(PatternSet<char>(std::vector<std::string>{"AC", ""}), std::invalid_argument);
+}
+
+TEST(MyArrayTest, FindAllOccurrences)
+{
+    std::string text = "AAAACGAAACG";
+    myArray<char, FlatStorage> flat(text.data(), text.size());
+    Pattern<char> pair("AA", 2);
+    std::vector<size_t> positions;
+    flat.findAll(pair, [&](size_t position) { positions.push_back(position); });
+    EXPECT_EQ(positions, (std::vector<size_t>{0, 1, 2, 6, 7}));
+    std::vector<size_t> written;
+    flat.findAll(Pattern<char>("ACG", 3), std::back_inserter(written));
+    EXPECT_EQ(written, (std::vector<size_t>{3, 8}));
+    size_t calls = 0;
+    flat.findAll(pair, [&](size_t) { return ++calls < 2; });
+    EXPECT_EQ(calls, 2);
+
+    // non-throwing lookups
+    EXPECT_EQ(flat.find(Pattern<char>("CGA", 3)), 4);
+    EXPECT_EQ(flat.find(Pattern<char>("CGA", 3), 5), std::nullopt);
+    EXPECT_EQ(flat.find(myArray<char>("AC", 2), 4), 8);
+
+    // KMP keeps overlapping matches without rescanning
+    int values[] = {1, 1, 1, 2, 1, 1};
+    myArray<int> numbers(values, 6);
+    int motif[] = {1, 1};
+    std::vector<size_t> found;
+    numbers.findAll(Pattern<int>(motif, 2), std::back_inserter(found));
+    EXPECT_EQ(found, (std::vector<size_t>{0, 1, 4}));
+#if __cpp_lib_generator
+    std::vector<size_t> generated;
+    for(size_t position: flat.findAll(pair))
+        generated.push_back(position);
+    EXPECT_EQ(generated, positions);
+#endif
+}
+
+TEST(MyArrayTest, NonThrowingLookups)
+{
+    int values[] = {4, 9, 2, 9, 7};
+    myArray<int, FlatStorage> flat(values, 5);
+    myArray<int> linked(values, 5);
+    EXPECT_EQ(flat.try_index(9), 1);
+    EXPECT_EQ(flat.try_index(9, 2), 3);
+    EXPECT_EQ(linked.try_index(5), std::nullopt);
+    EXPECT_EQ(flat.try_min(), 2);
+    EXPECT_EQ(linked.try_max(), 9);
+    EXPECT_EQ(linked.try_minmax(), std::make_pair(2, 9));
+    EXPECT_EQ(flat.try_pop(7), std::nullopt);
+    EXPECT_EQ(flat.try_pop(-2), 9);
+    EXPECT_EQ(flat.length(), 4);
+
+    linked.remove(5);
+    EXPECT_EQ(linked.length(), 5);
+    linked.remove(9);
+    EXPECT_EQ(linked.str(), "4, 2, 9, 7");
+
+    myArray<int, FlatStorage> empty;
+    EXPECT_EQ(empty.try_min(), std::nullopt);
+    EXPECT_EQ(empty.try_max(), std::nullopt);
+    EXPECT_EQ(empty.try_pop(), std::nullopt);
+    EXPECT_THROW(empty.min(), std::out_of_range);
+    EXPECT_THROW(empty.pop(), std::out_of_range);
+    EXPECT_THROW(flat.index(5), std::out_of_range);
+}
+
+TEST(MyArrayTest, HashAndEquality)
+{
+    // byte arrays: equal contents, equal hashes, whatever the length
+    std::string text(200, 'A');
+    for(size_t i = 0; i < text.size(); ++i)
+        text[i] = "ACGT"[(i * i + 3 * i) % 4];
+    std::unordered_set<size_t> hashes;
+    for(size_t n = 0; n <= text.size(); ++n)
+    {
+        myArray<char, FlatStorage> first(text.data(), n), second(text.data(), n);
+        EXPECT_TRUE(first == second);
+        EXPECT_EQ(first.hash(), second.hash());
+        EXPECT_EQ((std::hash<myArray<char, FlatStorage>>{}(first)), first.hash());
+        hashes.insert(first.hash());
+    }
+    EXPECT_EQ(hashes.size(), text.size() + 1);
+    myArray<char, FlatStorage> left(text.data(), 100), right(text.data(), 100);
+    right(57) = right(57) == 'A' ? 'C' : 'A';
+    EXPECT_FALSE(left == right);
+    EXPECT_NE(left.hash(), right.hash());
+
+    // element-wise types and unordered containers
+    double values[] = {0.0, 1.5, -2.25};
+    double negativeZero[] = {-0.0, 1.5, -2.25};
+    myArray<double, FlatStorage> doubles(values, 3), zeros(negativeZero, 3);
+    EXPECT_TRUE(doubles == zeros);
+    EXPECT_EQ(doubles.hash(), zeros.hash());
+    std::unordered_set<myArray<int>> sets;
+    int a[] = {1, 2, 3}, b[] = {1, 2, 4};
+    sets.insert(myArray<int>(a, 3));
+    sets.insert(myArray<int>(a, 3));
+    sets.insert(myArray<int>(b, 3));
+    EXPECT_EQ(sets.size(), 2);
+    EXPECT_TRUE(sets.contains(myArray<int>(b, 3)));
+
+    // cached hashes live in HashedArray and are dropped by every modification made through it
+    HashedArray<myArray<char, FlatStorage>> cached(myArray<char, FlatStorage>(text.data(), 50));
+    size_t plain = cached.get().hash();
+    EXPECT_FALSE(cached.hashCached());
+    EXPECT_EQ(cached.hash(), plain);
+    EXPECT_TRUE(cached.hashCached());
+    auto copy = cached;
+    EXPECT_TRUE(copy.hashCached());
+    cached.append('T');
+    EXPECT_FALSE(cached.hashCached());
+    std::string appended = text.substr(0, 50) + 'T';
+    EXPECT_EQ(cached.hash(), (myArray<char, FlatStorage>(appended.data(), 51).hash()));
+    cached.modify([](auto &array) { array(0) = 'G'; });
+    EXPECT_FALSE(cached.hashCached());
+    EXPECT_NE(cached.hash(), copy.hash());
+    EXPECT_FALSE(cached == copy);
+    cached.pop();
+    cached.modify([&](auto &array) { array(0) = text[0]; });
+    EXPECT_TRUE(cached == copy);
+    EXPECT_EQ(cached.hash(), plain);
+    std::unordered_set<HashedArray<myArray<char, FlatStorage>>> keys{cached, copy};
+    EXPECT_EQ(keys.size(), 1);
+    static_assert(sizeof(myArray<int, FlatStorage>) < sizeof(HashedArray<myArray<int, FlatStorage>>));
+}
+
+TEST(MyArrayTest, FingerprintIndex)
+{
+    std::string text(3000, 'A');
+    std::srand(25);
+    for(char &base: text)
+        base = "ACGT"[std::rand() % 4];
+    myArray<char, FlatStorage> flat(text.data(), text.size());
+    FingerprintIndex index(flat, 6);
+    EXPECT_EQ(index.windows(), text.size() - 5);
+
+    // every query agrees with a plain search, including patterns that do not occur
+    for(size_t start = 0; start < 500; start += 7)
+    {
+        std::string motif = text.substr(start, 6);
+        EXPECT_EQ(index.find(motif), text.find(motif));
+        EXPECT_EQ(index.find(motif, start + 1).value_or(std::string::npos), text.find(motif, start + 1));
+        size_t expected = 0;
+        for(size_t pos = text.find(motif); pos != std::string::npos; pos = text.find(motif, pos + 1))
+            ++expected;
+        EXPECT_EQ(index.count(motif), expected);
+    }
+    EXPECT_EQ(index.find(std::string("NNNNNN")), std::nullopt);
+    EXPECT_THROW(index.find(std::string("ACG")), std::invalid_argument);
+
+    // appends through the index or straight to the array
+    for(char base: std::string("GATTACA"))
+    {
+        index.append(base);
+        text.push_back(base);
+    }
+    EXPECT_EQ(index.find(std::string("GATTAC"), 2990), text.size() - 7);
+    flat.append('G');
+    text.push_back('G');
+    EXPECT_EQ(index.find(std::string("TTACAG"), 2990), std::nullopt);
+    index.sync();
+    EXPECT_EQ(index.find(std::string("TTACAG"), 2990), text.size() - 6);
+
+    // other edits need a rebuild
+    flat.erase(0, 100);
+    text.erase(0, 100);
+    index.rebuild();
+    EXPECT_EQ(index.windows(), text.size() - 5);
+    EXPECT_EQ(index.find(text.substr(1234, 6)), text.find(text.substr(1234, 6)));
+    EXPECT_THROW(FingerprintIndex(flat, 0), std::invalid_argument);
+}
+
+TEST(MyArrayTest, MinMaxSkipsNaN)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> values(5000);
+    for(size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<float>((i * 37) % 1001) - 500.0f;
+    // NaN first, inside vector blocks, at a chunk start and in the scalar tail
+    for(size_t i: {size_t(0), size_t(9), size_t(1250), size_t(2500), size_t(4999)})
+        values[i] = nan;
+    float smallest = std::numeric_limits<float>::infinity(), largest = -smallest;
+    for(float value: values)
+        if(value == value)
+        {
+            smallest = std::min(smallest, value);
+            largest = std::max(largest, value);
+        }
+    for(size_t n: {size_t(3), size_t(20), values.size()})
+    {
+        myArray<float, FlatStorage> flat(values.data(), n);
+        myArray<float> linked(values.data(), n);
+        auto expected = arraySimd::minmaxScalar(values.data(), n);
+        EXPECT_FALSE(std::isnan(expected.first));
+        EXPECT_EQ(flat.minmax(), expected);
+        EXPECT_EQ(linked.minmax(), expected);
+        EXPECT_EQ(flat.min(), expected.first);
+        EXPECT_EQ(linked.max(), expected.second);
+        EXPECT_EQ(flat.slice(0, n - 1).minmax(), expected);
+    }
+    myArray<float, FlatStorage> all(values.data(), values.size());
+    EXPECT_EQ(all.minmax(), std::make_pair(smallest, largest));
+
+    // only NaN: NaN
+    std::vector<double> nans(100, std::numeric_limits<double>::quiet_NaN());
+    myArray<double, FlatStorage> flatNans(nans.data(), nans.size());
+    myArray<double> linkedNans(nans.data(), nans.size());
+    EXPECT_TRUE(std::isnan(flatNans.min()) && std::isnan(flatNans.max()));
+    EXPECT_TRUE(std::isnan(linkedNans.minmax().first) && std::isnan(linkedNans.minmax().second));
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
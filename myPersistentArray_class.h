@@ -0,0 +1,482 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "myArray_class.h"
+
+// Persistent (versioned) sequence: the same chunked treap as myRope, but nodes are immutable and shared between
+// versions. Copying an array (or snapshot()) is O(1); an edit copies only the O(log n) nodes on the path to the
+// edit and the chunk it touches, leaving every earlier version intact. Chunks are SharedStorage arrays, so copying
+// a node shares its elements until the chunk itself is modified.
+template <typename T>
+class myPersistentArray
+{
+private:
+    static constexpr size_t chunkCapacity = std::max<size_t>(64, 4096 / sizeof(T));
+    struct Chunk
+    {
+        myArray<T, SharedStorage> data;
+        size_t total{0};
+        uint32_t priority;
+        std::shared_ptr<const Chunk> left, right;
+    };
+    // Nodes are always created non-const by make(), so a node that only this version points to may be modified
+    // in place (see own()); every other node is treated as read-only.
+    using Link = std::shared_ptr<const Chunk>;
+    Link root;
+    uint64_t seed{0x9E3779B97F4A7C15ull};
+    uint32_t nextPriority();
+    static size_t total(const Link &node) { return node ? node->total : 0; };
+    static Link make(myArray<T, SharedStorage> data, uint32_t priority, Link left, Link right);
+    static myArray<T, SharedStorage> piece(const T *first, size_t count);
+    static Link merge(const Link &first, const Link &second);
+    static Link popFront(const Link &node, Link &front);
+    static Link appendToBack(const Link &node, const Chunk &from);
+    static Link join(const Link &first, const Link &second);
+    static std::pair<Link, Link> split(const Link &node, size_t k);
+    template <typename It>
+    Link build(It first, size_t count);
+    std::pair<const Chunk *, size_t> locate(size_t index) const;
+    static T &own(Link &node, size_t index);
+    template <typename F>
+    static void visit(const Chunk *node, F &f);
+public:
+    class const_iterator;
+    using value_type = T;
+    // elements can only be changed through the array, so both iterator types are read-only
+    using iterator = const_iterator;
+    using reverse_iterator = std::reverse_iterator<const_iterator>;
+    using const_reverse_iterator = reverse_iterator;
+
+    myPersistentArray() = default;
+    myPersistentArray(const T *inputArray, size_t len);
+    myPersistentArray snapshot() const { return *this; };
+    size_t length() const { return total(root); };
+    size_t size() const { return total(root); };
+    bool empty() const { return !root; };
+    size_t chunks() const;
+    bool sharesWith(const myPersistentArray &other) const { return root && root == other.root; };
+    const T &at(long long index) const;
+    T &operator()(size_t index);
+    const T &operator()(size_t index) const;
+    void append(const T &element);
+    template <std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(size_t pos, It first, It last);
+    void insert(size_t pos, size_t count, const T &element);
+    void erase(size_t pos, size_t count = 1);
+    void clear() { root.reset(); };
+    void concat(const myPersistentArray &other);
+    void operator+=(const myPersistentArray &other) { concat(other); };
+    template <typename F>
+    void forEachChunk(F f) const;
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    size_t countIf(Predicate pred) const;
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    size_t countIf(Policy &&policy, Predicate pred) const;
+    std::string str(std::string del = ", ") const;
+    const_iterator begin() const { return const_iterator(this, 0); };
+    const_iterator end() const { return const_iterator(this, length()); };
+    const_iterator cbegin() const { return begin(); };
+    const_iterator cend() const { return end(); };
+    reverse_iterator rbegin() const { return reverse_iterator(end()); };
+    reverse_iterator rend() const { return reverse_iterator(begin()); };
+};
+
+// Random-access iterator over one version of the array. Like myRope's iterator it remembers the chunk of the
+// last element it read; editing the array it came from invalidates it, as with myRope.
+template <typename T>
+class myPersistentArray<T>::const_iterator
+{
+private:
+    const myPersistentArray *array = nullptr;
+    std::ptrdiff_t index = 0;
+    mutable const Chunk *chunk = nullptr;
+    mutable size_t chunkStart = 0;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+    const_iterator() = default;
+    const_iterator(const myPersistentArray *array, std::ptrdiff_t index) : array(array), index(index) {};
+    reference operator*() const { return (*this)[0]; };
+    pointer operator->() const { return &**this; };
+    reference operator[](difference_type offset) const
+    {
+        size_t target = size_t(index + offset);
+        if(!chunk || target < chunkStart || target >= chunkStart + chunk->data.length())
+            std::tie(chunk, chunkStart) = array->locate(target);
+        return chunk->data(target - chunkStart);
+    };
+    const_iterator &operator++() { ++index; return *this; };
+    const_iterator operator++(int) { const_iterator old = *this; ++index; return old; };
+    const_iterator &operator--() { --index; return *this; };
+    const_iterator operator--(int) { const_iterator old = *this; --index; return old; };
+    const_iterator &operator+=(difference_type offset) { index += offset; return *this; };
+    const_iterator &operator-=(difference_type offset) { index -= offset; return *this; };
+    friend const_iterator operator+(const_iterator it, difference_type offset) { return it += offset; };
+    friend const_iterator operator+(difference_type offset, const_iterator it) { return it += offset; };
+    friend const_iterator operator-(const_iterator it, difference_type offset) { return it -= offset; };
+    friend difference_type operator-(const const_iterator &first, const const_iterator &second) { return first.index - second.index; };
+    friend bool operator==(const const_iterator &first, const const_iterator &second) { return first.index == second.index; };
+    friend auto operator<=>(const const_iterator &first, const const_iterator &second) { return first.index <=> second.index; };
+};
+
+
+template <typename T>
+uint32_t myPersistentArray<T>::nextPriority()
+{
+    // xorshift64: priorities only need to be well spread, not unpredictable
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return static_cast<uint32_t>(seed >> 32);
+}
+
+template <typename T>
+typename myPersistentArray<T>::Link myPersistentArray<T>::make(myArray<T, SharedStorage> data, uint32_t priority,
+                                                                Link left, Link right)
+{
+    size_t count = total(left) + data.length() + total(right);
+    return std::make_shared<Chunk>(Chunk{std::move(data), count, priority, std::move(left), std::move(right)});
+}
+
+template <typename T>
+myArray<T, SharedStorage> myPersistentArray<T>::piece(const T *first, size_t count)
+{
+    myArray<T, SharedStorage> output;
+    output.reserve(count);
+    output.insert(0, first, first + count);
+    return output;
+}
+
+template <typename T>
+typename myPersistentArray<T>::Link myPersistentArray<T>::merge(const Link &first, const Link &second)
+{
+    if(!first)
+        return second;
+    if(!second)
+        return first;
+    if(first->priority > second->priority)
+        return make(first->data, first->priority, first->left, merge(first->right, second));
+    return make(second->data, second->priority, merge(first, second->left), second->right);
+}
+
+// Returns the tree without its leftmost chunk, which is stored in `front`.
+template <typename T>
+typename myPersistentArray<T>::Link myPersistentArray<T>::popFront(const Link &node, Link &front)
+{
+    if(!node->left)
+    {
+        front = node;
+        return node->right;
+    }
+    return make(node->data, node->priority, popFront(node->left, front), node->right);
+}
+
+template <typename T>
+typename myPersistentArray<T>::Link myPersistentArray<T>::appendToBack(const Link &node, const Chunk &from)
+{
+    if(node->right)
+        return make(node->data, node->priority, node->left, appendToBack(node->right, from));
+    myArray<T, SharedStorage> data = node->data;
+    data.insert(data.length(), from.data.begin(), from.data.end());
+    return make(std::move(data), node->priority, node->left, nullptr);
+}
+
+// Concatenates two trees, combining the chunks at the seam when they fit into one (see myRope::join).
+template <typename T>
+typename myPersistentArray<T>::Link myPersistentArray<T>::join(const Link &first, const Link &second)
+{
+    if(first && second)
+    {
+        const Chunk *back = first.get();
+        while(back->right)
+            back = back->right.get();
+        const Chunk *front = second.get();
+        while(front->left)
+            front = front->left.get();
+        if(back->data.length() + front->data.length() <= chunkCapacity)
+        {
+            Link detached;
+            Link rest = popFront(second, detached);
+            return merge(appendToBack(first, *detached), rest);
+        }
+    }
+    return merge(first, second);
+}
+
+// Splits the tree into its first k elements and the rest. Only the nodes on the path to position k are copied.
+template <typename T>
+std::pair<typename myPersistentArray<T>::Link, typename myPersistentArray<T>::Link>
+myPersistentArray<T>::split(const Link &node, size_t k)
+{
+    if(!node)
+        return {nullptr, nullptr};
+    size_t before = total(node->left);
+    size_t here = node->data.length();
+    if(k == 0)
+        return {nullptr, node};
+    if(k == node->total)
+        return {node, nullptr};
+    if(k <= before)
+    {
+        auto [first, second] = split(node->left, k);
+        return {first, make(node->data, node->priority, second, node->right)};
+    }
+    if(k >= before + here)
+    {
+        auto [first, second] = split(node->right, k - before - here);
+        return {make(node->data, node->priority, node->left, first), second};
+    }
+    // the upper part keeps this node's priority, which already dominates the right subtree
+    size_t cut = k - before;
+    const T *elements = node->data.data();
+    return {make(piece(elements, cut), node->priority, node->left, nullptr),
+            make(piece(elements + cut, here - cut), node->priority, nullptr, node->right)};
+}
+
+template <typename T>
+template <typename It>
+typename myPersistentArray<T>::Link myPersistentArray<T>::build(It first, size_t count)
+{
+    Link output;
+    while(count > 0)
+    {
+        size_t piece = std::min(count, chunkCapacity);
+        myArray<T, SharedStorage> data;
+        data.reserve(piece);
+        for(size_t i = 0; i < piece; ++i, ++first)
+            data.append(*first);
+        output = merge(output, make(std::move(data), nextPriority(), nullptr, nullptr));
+        count -= piece;
+    }
+    return output;
+}
+
+// Chunk holding the element at `index` and the position of the chunk's first element.
+template <typename T>
+std::pair<const typename myPersistentArray<T>::Chunk *, size_t> myPersistentArray<T>::locate(size_t index) const
+{
+    const Chunk *node = root.get();
+    size_t start = 0;
+    while(node)
+    {
+        size_t before = total(node->left);
+        if(index < before)
+            node = node->left.get();
+        else if(index < before + node->data.length())
+            return {node, start + before};
+        else
+        {
+            index -= before + node->data.length();
+            start += before + node->data.length();
+            node = node->right.get();
+        }
+    }
+    throw std::out_of_range("Index is out of range.");
+}
+
+// Writable reference to an element of this version: every node on the path that another version still uses is
+// copied first (sharing its children and, until detached, its chunk), so no other version can see the write.
+template <typename T>
+T &myPersistentArray<T>::own(Link &node, size_t index)
+{
+    if(node.use_count() > 1)
+        node = std::make_shared<Chunk>(*node);
+    auto &chunk = const_cast<Chunk &>(*node);
+    size_t before = total(chunk.left);
+    if(index < before)
+        return own(chunk.left, index);
+    index -= before;
+    if(index < chunk.data.length())
+        return chunk.data(index);
+    return own(chunk.right, index - chunk.data.length());
+}
+
+template <typename T>
+template <typename F>
+void myPersistentArray<T>::visit(const Chunk *node, F &f)
+{
+    if(!node)
+        return;
+    visit(node->left.get(), f);
+    f(node->data.data(), node->data.length());
+    visit(node->right.get(), f);
+}
+
+template <typename T>
+myPersistentArray<T>::myPersistentArray(const T *inputArray, size_t len)
+{
+    root = build(inputArray, len);
+}
+
+template <typename T>
+size_t myPersistentArray<T>::chunks() const
+{
+    size_t output = 0;
+    forEachChunk([&](const T *, size_t) { ++output; });
+    return output;
+}
+
+template <typename T>
+const T &myPersistentArray<T>::at(long long index) const
+{
+    if(index < 0)
+        index += length();
+    if(index < 0 || std::cmp_greater_equal(index, length()))
+        throw std::out_of_range("Index is out of range.");
+    return (*this)(index);
+}
+
+template <typename T>
+T &myPersistentArray<T>::operator()(size_t index)
+{
+    if(index >= length())
+        throw std::out_of_range("Index is out of range.");
+    return own(root, index);
+}
+
+template <typename T>
+const T &myPersistentArray<T>::operator()(size_t index) const
+{
+    auto [chunk, start] = locate(index);
+    return chunk->data(index - start);
+}
+
+// Appends into the last chunk while it has room. Only the nodes of the right spine that another version still
+// uses are copied (see own()), and the last chunk's elements only if another version shares them, so building an
+// array element by element costs O(log n) per element instead of a copy of the last chunk.
+template <typename T>
+void myPersistentArray<T>::append(const T &element)
+{
+    const Chunk *back = root.get();
+    while(back && back->right)
+        back = back->right.get();
+    if(!back || back->data.length() == chunkCapacity)
+    {
+        myArray<T, SharedStorage> data;
+        data.reserve(chunkCapacity);
+        data.append(element);
+        root = merge(root, make(std::move(data), nextPriority(), nullptr, nullptr));
+        return;
+    }
+    Link *node = &root;
+    while(true)
+    {
+        if(node->use_count() > 1)
+            *node = std::make_shared<Chunk>(**node);
+        auto &chunk = const_cast<Chunk &>(**node);
+        if(!chunk.right)
+        {
+            chunk.data.append(element);
+            break;
+        }
+        node = &chunk.right;
+    }
+    for(const Chunk *spine = root.get(); spine; spine = spine->right.get())
+        ++const_cast<Chunk *>(spine)->total;
+}
+
+template <typename T>
+template <std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+void myPersistentArray<T>::insert(size_t pos, It first, It last)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    auto count = static_cast<size_t>(std::distance(first, last));
+    if(count == 0)
+        return;
+    Link middle = build(first, count);
+    auto [before, after] = split(root, pos);
+    root = join(join(before, middle), after);
+}
+
+template <typename T>
+void myPersistentArray<T>::insert(size_t pos, size_t count, const T &element)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    if(count == 0)
+        return;
+    std::vector<T> copies(count, element);
+    insert(pos, copies.begin(), copies.end());
+}
+
+template <typename T>
+void myPersistentArray<T>::erase(size_t pos, size_t count)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    count = std::min(count, length() - pos);
+    if(count == 0)
+        return;
+    auto [before, rest] = split(root, pos);
+    root = join(before, split(rest, count).second);
+}
+
+template <typename T>
+void myPersistentArray<T>::concat(const myPersistentArray &other)
+{
+    root = join(root, other.root);
+}
+
+template <typename T>
+template <typename F>
+void myPersistentArray<T>::forEachChunk(F f) const
+{
+    visit(root.get(), f);
+}
+
+template <typename T>
+template <typename Predicate> requires std::predicate<Predicate &, const T &>
+size_t myPersistentArray<T>::countIf(Predicate pred) const
+{
+    return countIf(arrayParallel::seq, std::move(pred));
+}
+
+template <typename T>
+template <typename Policy, typename Predicate>
+        requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+size_t myPersistentArray<T>::countIf(Policy &&, Predicate pred) const
+{
+    constexpr bool parallel = arrayParallel::runsInParallel<Policy>;
+    std::vector<std::pair<const T *, size_t>> spans;
+    forEachChunk([&](const T *data, size_t n) { spans.emplace_back(data, n); });
+    std::vector<size_t> partial(parallel ? std::clamp<size_t>(spans.size(), 1, arrayParallel::chunksFor(length())) : 1);
+    arrayParallel::forChunks(spans.size(), partial.size(), [&](size_t begin, size_t end, unsigned piece) {
+        size_t output = 0;
+        for(size_t s = begin; s < end; ++s)
+            for(size_t i = 0; i < spans[s].second; ++i)
+                output += static_cast<bool>(std::invoke(pred, spans[s].first[i]));
+        partial[piece] = output;
+    });
+    size_t output = 0;
+    for(size_t count: partial)
+        output += count;
+    return output;
+}
+
+template <typename T>
+std::string myPersistentArray<T>::str(std::string del) const
+{
+    std::ostringstream output;
+    bool first = true;
+    for(const T &element: *this)
+    {
+        if(!first)
+            output << del;
+        output << element;
+        first = false;
+    }
+    return output.str();
+}
@@ -0,0 +1,141 @@
+#include "myPersistentArray_class.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+
+std::string contents(const myPersistentArray<char> &array)
+{
+    return std::string(array.begin(), array.end());
+}
+
+TEST(MyPersistentArrayTest, DefaultConstructor)
+{
+    myPersistentArray<int> array;
+    EXPECT_EQ(array.length(), 0);
+    EXPECT_TRUE(array.empty());
+    EXPECT_EQ(array.chunks(), 0);
+    EXPECT_THROW(array.at(0), std::out_of_range);
+    EXPECT_THROW(array(0) = 1, std::out_of_range);
+}
+
+TEST(MyPersistentArrayTest, EditsKeepEveryVersion)
+{
+    myPersistentArray<char> current;
+    std::string reference;
+    std::vector<myPersistentArray<char>> versions;
+    std::vector<std::string> expected;
+    std::srand(11);
+    for(int step = 0; step < 1500; ++step)
+    {
+        size_t pos = std::rand() % (reference.size() + 1);
+        int action = std::rand() % 3;
+        if(action == 0 || reference.size() < 10)
+        {
+            std::string bases(std::rand() % 40 + 1, "ACGT"[step % 4]);
+            current.insert(pos, bases.begin(), bases.end());
+            reference.insert(pos, bases);
+        }
+        else if(action == 1)
+        {
+            size_t count = std::rand() % 30;
+            current.erase(pos, count);
+            reference.erase(pos, count);
+        }
+        else if(pos < reference.size())
+        {
+            current(pos) = 'N';
+            reference[pos] = 'N';
+        }
+        if(step % 50 == 0)
+        {
+            versions.push_back(current.snapshot());
+            expected.push_back(reference);
+        }
+    }
+    EXPECT_EQ(contents(current), reference);
+    for(size_t v = 0; v < versions.size(); ++v)
+        ASSERT_EQ(contents(versions[v]), expected[v]);
+}
+
+TEST(MyPersistentArrayTest, SnapshotsShareStructure)
+{
+    std::string text(100000, 'A');
+    for(size_t i = 0; i < text.size(); ++i)
+        text[i] = "ACGT"[i * 13 % 4];
+    myPersistentArray<char> original(text.data(), text.size());
+    myPersistentArray<char> copy = original.snapshot();
+    EXPECT_TRUE(copy.sharesWith(original));
+    EXPECT_GT(original.chunks(), 10);
+
+    // writing through operator() copies only the path to one chunk, then keeps writing in place
+    copy(50000) = 'N';
+    copy(50001) = 'N';
+    EXPECT_FALSE(copy.sharesWith(original));
+    EXPECT_EQ(original.at(50000), text[50000]);
+    EXPECT_EQ(copy.at(50000), 'N');
+    EXPECT_EQ(copy.at(50001), 'N');
+    size_t shared = 0, chunks = 0;
+    std::vector<const char *> originalChunks;
+    original.forEachChunk([&](const char *data, size_t) { originalChunks.push_back(data); });
+    copy.forEachChunk([&](const char *data, size_t) {
+        shared += std::find(originalChunks.begin(), originalChunks.end(), data) != originalChunks.end();
+        ++chunks;
+    });
+    EXPECT_EQ(shared, chunks - 1);
+
+    myPersistentArray<char> edited = original;
+    edited.insert(70000, 3, 'G');
+    edited.erase(10, 5);
+    EXPECT_EQ(original.length(), text.size());
+    EXPECT_EQ(contents(original), text);
+    EXPECT_EQ(edited.length(), text.size() - 2);
+    EXPECT_EQ(edited.at(69995), 'G');
+}
+
+TEST(MyPersistentArrayTest, ConcatAndScans)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    std::vector<int> values(30000);
+    for(size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i % 10);
+    myPersistentArray<int> array(values.data(), values.size());
+    myPersistentArray<int> twice = array;
+    twice += array;
+    EXPECT_EQ(array.length(), 30000);
+    EXPECT_EQ(twice.length(), 60000);
+    auto isSeven = [](int n) { return n == 7; };
+    EXPECT_EQ(array.countIf(isSeven), 3000);
+    EXPECT_EQ(twice.countIf(arrayParallel::par, isSeven), 6000);
+    EXPECT_EQ(twice.at(-1), 9);
+
+    static_assert(std::random_access_iterator<myPersistentArray<int>::iterator>);
+    EXPECT_TRUE(std::equal(array.begin(), array.end(), values.begin(), values.end()));
+    EXPECT_TRUE(std::equal(array.rbegin(), array.rend(), values.rbegin(), values.rend()));
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyPersistentArrayTest, AppendsFillTheLastChunk)
+{
+    myPersistentArray<char> array;
+    std::string reference;
+    std::vector<std::pair<myPersistentArray<char>, std::string>> versions;
+    for(size_t i = 0; i < 20000; ++i)
+    {
+        if(i % 3000 == 0)
+            versions.emplace_back(array.snapshot(), reference);
+        array.append("ACGT"[i % 4]);
+        reference.push_back("ACGT"[i % 4]);
+    }
+    EXPECT_EQ(contents(array), reference);
+    EXPECT_LE(array.chunks(), reference.size() / 4096 + 1);
+    // appending after a snapshot never shows up in it
+    for(const auto &[version, text]: versions)
+        EXPECT_EQ(contents(version), text);
+}
@@ -0,0 +1,512 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "myArray_class.h"
+
+// Sequence container for very long, heavily edited sequences: a balanced tree (treap ordered by position) of
+// FlatStorage chunks of up to chunkCapacity elements. Indexed access, insert, erase, split and concat are
+// O(log n) in the number of chunks; scans walk the chunks and run over plain contiguous buffers.
+template <typename T>
+class myRope
+{
+private:
+    static constexpr size_t chunkCapacity = std::max<size_t>(64, 4096 / sizeof(T));
+    struct Chunk
+    {
+        myArray<T, FlatStorage> data;
+        size_t total{0};
+        uint32_t priority;
+        std::unique_ptr<Chunk> left, right;
+    };
+    using Link = std::unique_ptr<Chunk>;
+    Link root;
+    uint64_t seed{0x9E3779B97F4A7C15ull};
+    uint32_t nextPriority();
+    static size_t total(const Link &node) { return node ? node->total : 0; };
+    static void update(Chunk *node);
+    static Link merge(Link first, Link second);
+    static Link popFront(Link node, Link &front);
+    static void appendToBack(Chunk *node, Chunk &from);
+    static Link clone(const Link &node);
+    Link join(Link first, Link second);
+    void split(Link node, size_t k, Link &first, Link &second);
+    template <typename It>
+    Link build(It first, size_t count);
+    std::pair<Chunk *, size_t> locate(size_t index) const;
+    template <typename F>
+    static void visit(const Chunk *node, F &f);
+public:
+    template <bool Const>
+    class basicIterator;
+    using value_type = T;
+    using iterator = basicIterator<false>;
+    using const_iterator = basicIterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    myRope() = default;
+    myRope(const T *inputArray, size_t len);
+    myRope(const myRope &other);
+    myRope(myRope &&other) noexcept = default;
+    myRope &operator=(const myRope &other);
+    myRope &operator=(myRope &&other) noexcept = default;
+    size_t length() const { return total(root); };
+    size_t size() const { return total(root); };
+    bool empty() const { return !root; };
+    size_t chunks() const;
+    const T &at(long long index) const;
+    T &operator()(size_t index);
+    const T &operator()(size_t index) const;
+    void append(const T &element);
+    template <std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+    void insert(size_t pos, It first, It last);
+    void insert(size_t pos, size_t count, const T &element);
+    void erase(size_t pos, size_t count = 1);
+    void clear() { root.reset(); };
+    myRope split(size_t pos);
+    void concat(myRope &&other);
+    void operator+=(myRope &&other) { concat(std::move(other)); };
+    template <typename F>
+    void forEachChunk(F f) const;
+    template <typename Predicate> requires std::predicate<Predicate &, const T &>
+    size_t countIf(Predicate pred) const;
+    template <typename Policy, typename Predicate>
+            requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+    size_t countIf(Policy &&policy, Predicate pred) const;
+    std::string str(std::string del = ", ") const;
+    iterator begin() { return iterator(this, 0); };
+    iterator end() { return iterator(this, length()); };
+    const_iterator begin() const { return const_iterator(this, 0); };
+    const_iterator end() const { return const_iterator(this, length()); };
+    const_iterator cbegin() const { return begin(); };
+    const_iterator cend() const { return end(); };
+    reverse_iterator rbegin() { return reverse_iterator(end()); };
+    reverse_iterator rend() { return reverse_iterator(begin()); };
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); };
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); };
+};
+
+// Random-access iterator over a rope. It remembers the chunk of the last element it read, so walking the rope
+// in either direction only descends the tree once per chunk.
+template <typename T>
+template <bool Const>
+class myRope<T>::basicIterator
+{
+private:
+    using RopeType = std::conditional_t<Const, const myRope, myRope>;
+    RopeType *rope = nullptr;
+    std::ptrdiff_t index = 0;
+    mutable Chunk *chunk = nullptr;
+    mutable size_t chunkStart = 0;
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T, T> *;
+    using reference = std::conditional_t<Const, const T, T> &;
+    basicIterator() = default;
+    basicIterator(RopeType *rope, std::ptrdiff_t index) : rope(rope), index(index) {};
+    operator basicIterator<true>() const requires (!Const) { return basicIterator<true>(rope, index); };
+    reference operator*() const { return (*this)[0]; };
+    pointer operator->() const { return &**this; };
+    // reads through the remembered chunk too, so indexing from a fixed iterator walks the tree once per chunk
+    reference operator[](difference_type offset) const
+    {
+        size_t target = size_t(index + offset);
+        if(!chunk || target < chunkStart || target >= chunkStart + chunk->data.length())
+            std::tie(chunk, chunkStart) = rope->locate(target);
+        return chunk->data(target - chunkStart);
+    };
+    basicIterator &operator++() { ++index; return *this; };
+    basicIterator operator++(int) { basicIterator old = *this; ++index; return old; };
+    basicIterator &operator--() { --index; return *this; };
+    basicIterator operator--(int) { basicIterator old = *this; --index; return old; };
+    basicIterator &operator+=(difference_type offset) { index += offset; return *this; };
+    basicIterator &operator-=(difference_type offset) { index -= offset; return *this; };
+    friend basicIterator operator+(basicIterator it, difference_type offset) { return it += offset; };
+    friend basicIterator operator+(difference_type offset, basicIterator it) { return it += offset; };
+    friend basicIterator operator-(basicIterator it, difference_type offset) { return it -= offset; };
+    friend difference_type operator-(const basicIterator &first, const basicIterator &second) { return first.index - second.index; };
+    friend bool operator==(const basicIterator &first, const basicIterator &second) { return first.index == second.index; };
+    friend auto operator<=>(const basicIterator &first, const basicIterator &second) { return first.index <=> second.index; };
+};
+
+
+template <typename T>
+uint32_t myRope<T>::nextPriority()
+{
+    // xorshift64: priorities only need to be well spread, not unpredictable
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return static_cast<uint32_t>(seed >> 32);
+}
+
+template <typename T>
+void myRope<T>::update(Chunk *node)
+{
+    node->total = total(node->left) + node->data.length() + total(node->right);
+}
+
+template <typename T>
+typename myRope<T>::Link myRope<T>::merge(Link first, Link second)
+{
+    if(!first)
+        return second;
+    if(!second)
+        return first;
+    if(first->priority > second->priority)
+    {
+        first->right = merge(std::move(first->right), std::move(second));
+        update(first.get());
+        return first;
+    }
+    second->left = merge(std::move(first), std::move(second->left));
+    update(second.get());
+    return second;
+}
+
+// Detaches the leftmost chunk of the tree into `front` and returns what is left.
+template <typename T>
+typename myRope<T>::Link myRope<T>::popFront(Link node, Link &front)
+{
+    if(!node->left)
+    {
+        Link rest = std::move(node->right);
+        front = std::move(node);
+        return rest;
+    }
+    node->left = popFront(std::move(node->left), front);
+    update(node.get());
+    return node;
+}
+
+template <typename T>
+void myRope<T>::appendToBack(Chunk *node, Chunk &from)
+{
+    if(node->right)
+        appendToBack(node->right.get(), from);
+    else
+        node->data.insert(node->data.length(), from.data.begin(), from.data.end());
+    update(node);
+}
+
+template <typename T>
+typename myRope<T>::Link myRope<T>::clone(const Link &node)
+{
+    if(!node)
+        return nullptr;
+    Link output(new Chunk{node->data, node->total, node->priority, clone(node->left), clone(node->right)});
+    return output;
+}
+
+// Concatenates two trees. If the chunks meeting at the seam fit into one, they are combined, so repeated
+// small edits at the same place do not leave a trail of tiny chunks behind.
+template <typename T>
+typename myRope<T>::Link myRope<T>::join(Link first, Link second)
+{
+    if(first && second)
+    {
+        Chunk *back = first.get();
+        while(back->right)
+            back = back->right.get();
+        Chunk *front = second.get();
+        while(front->left)
+            front = front->left.get();
+        if(back->data.length() + front->data.length() <= chunkCapacity)
+        {
+            Link detached;
+            second = popFront(std::move(second), detached);
+            appendToBack(first.get(), *detached);
+        }
+    }
+    return merge(std::move(first), std::move(second));
+}
+
+// Splits the tree into its first k elements and the rest, cutting a chunk in two if k falls inside it.
+template <typename T>
+void myRope<T>::split(Link node, size_t k, Link &first, Link &second)
+{
+    if(!node)
+    {
+        first = nullptr;
+        second = nullptr;
+        return;
+    }
+    size_t before = total(node->left);
+    size_t here = node->data.length();
+    if(k <= before)
+    {
+        split(std::move(node->left), k, first, node->left);
+        update(node.get());
+        second = std::move(node);
+    }
+    else if(k >= before + here)
+    {
+        split(std::move(node->right), k - before - here, node->right, second);
+        update(node.get());
+        first = std::move(node);
+    }
+    else
+    {
+        // the upper part keeps this node's priority, which already dominates the right subtree
+        size_t cut = k - before;
+        Link upper(new Chunk{myArray<T, FlatStorage>(), 0, node->priority, nullptr, std::move(node->right)});
+        upper->data.insert(0, node->data.begin() + cut, node->data.end());
+        node->data.erase(cut, here - cut);
+        update(upper.get());
+        update(node.get());
+        first = std::move(node);
+        second = std::move(upper);
+    }
+}
+
+template <typename T>
+template <typename It>
+typename myRope<T>::Link myRope<T>::build(It first, size_t count)
+{
+    Link output;
+    while(count > 0)
+    {
+        size_t piece = std::min(count, chunkCapacity);
+        Link chunk(new Chunk{myArray<T, FlatStorage>(), 0, nextPriority(), nullptr, nullptr});
+        chunk->data.reserve(piece);
+        for(size_t i = 0; i < piece; ++i, ++first)
+            chunk->data.append(*first);
+        update(chunk.get());
+        output = merge(std::move(output), std::move(chunk));
+        count -= piece;
+    }
+    return output;
+}
+
+// Chunk holding the element at `index` and the position of the chunk's first element.
+template <typename T>
+std::pair<typename myRope<T>::Chunk *, size_t> myRope<T>::locate(size_t index) const
+{
+    Chunk *node = root.get();
+    size_t start = 0;
+    while(node)
+    {
+        size_t before = total(node->left);
+        if(index < before)
+            node = node->left.get();
+        else if(index < before + node->data.length())
+            return {node, start + before};
+        else
+        {
+            index -= before + node->data.length();
+            start += before + node->data.length();
+            node = node->right.get();
+        }
+    }
+    throw std::out_of_range("Index is out of range.");
+}
+
+template <typename T>
+template <typename F>
+void myRope<T>::visit(const Chunk *node, F &f)
+{
+    if(!node)
+        return;
+    visit(node->left.get(), f);
+    f(node->data.data(), node->data.length());
+    visit(node->right.get(), f);
+}
+
+template <typename T>
+myRope<T>::myRope(const T *inputArray, size_t len)
+{
+    root = build(inputArray, len);
+}
+
+template <typename T>
+myRope<T>::myRope(const myRope &other) : root(clone(other.root)), seed(other.seed)
+{
+}
+
+template <typename T>
+myRope<T> &myRope<T>::operator=(const myRope &other)
+{
+    if(this != &other)
+    {
+        root = clone(other.root);
+        seed = other.seed;
+    }
+    return *this;
+}
+
+template <typename T>
+size_t myRope<T>::chunks() const
+{
+    size_t output = 0;
+    forEachChunk([&](const T *, size_t) { ++output; });
+    return output;
+}
+
+template <typename T>
+const T &myRope<T>::at(long long index) const
+{
+    if(index < 0)
+        index += length();
+    if(index < 0 || std::cmp_greater_equal(index, length()))
+        throw std::out_of_range("Index is out of range.");
+    return (*this)(index);
+}
+
+template <typename T>
+T &myRope<T>::operator()(size_t index)
+{
+    auto [chunk, start] = locate(index);
+    return chunk->data(index - start);
+}
+
+template <typename T>
+const T &myRope<T>::operator()(size_t index) const
+{
+    auto [chunk, start] = locate(index);
+    return chunk->data(index - start);
+}
+
+// The last chunk usually has room, so appending costs one walk down the right spine to fix the totals; only a
+// full last chunk makes a new one, merged in along the same spine.
+template <typename T>
+void myRope<T>::append(const T &element)
+{
+    Chunk *back = root.get();
+    while(back && back->right)
+        back = back->right.get();
+    if(back && back->data.length() < chunkCapacity)
+    {
+        back->data.append(element);
+        for(Chunk *node = root.get(); node; node = node->right.get())
+            ++node->total;
+        return;
+    }
+    Link chunk(new Chunk{myArray<T, FlatStorage>(), 0, nextPriority(), nullptr, nullptr});
+    chunk->data.reserve(chunkCapacity);
+    chunk->data.append(element);
+    update(chunk.get());
+    root = merge(std::move(root), std::move(chunk));
+}
+
+template <typename T>
+template <std::forward_iterator It> requires std::constructible_from<T, std::iter_reference_t<It>>
+void myRope<T>::insert(size_t pos, It first, It last)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    auto count = static_cast<size_t>(std::distance(first, last));
+    if(count == 0)
+        return;
+    Link middle = build(first, count);
+    Link before, after;
+    split(std::move(root), pos, before, after);
+    root = join(join(std::move(before), std::move(middle)), std::move(after));
+}
+
+template <typename T>
+void myRope<T>::insert(size_t pos, size_t count, const T &element)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    if(count == 0)
+        return;
+    std::vector<T> copies(count, element);
+    insert(pos, copies.begin(), copies.end());
+}
+
+template <typename T>
+void myRope<T>::erase(size_t pos, size_t count)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    count = std::min(count, length() - pos);
+    if(count == 0)
+        return;
+    Link before, middle, after;
+    split(std::move(root), pos, before, after);
+    split(std::move(after), count, middle, after);
+    root = join(std::move(before), std::move(after));
+}
+
+template <typename T>
+myRope<T> myRope<T>::split(size_t pos)
+{
+    if(pos > length())
+        throw std::out_of_range("Index is out of range.");
+    myRope output;
+    output.seed = nextPriority() | 1;
+    Link before;
+    split(std::move(root), pos, before, output.root);
+    root = std::move(before);
+    return output;
+}
+
+template <typename T>
+void myRope<T>::concat(myRope &&other)
+{
+    if(this == &other)
+        return;
+    root = join(std::move(root), std::move(other.root));
+}
+
+template <typename T>
+template <typename F>
+void myRope<T>::forEachChunk(F f) const
+{
+    visit(root.get(), f);
+}
+
+template <typename T>
+template <typename Predicate> requires std::predicate<Predicate &, const T &>
+size_t myRope<T>::countIf(Predicate pred) const
+{
+    return countIf(arrayParallel::seq, std::move(pred));
+}
+
+template <typename T>
+template <typename Policy, typename Predicate>
+        requires arrayParallel::executionPolicy<Policy> && std::predicate<Predicate &, const T &>
+size_t myRope<T>::countIf(Policy &&, Predicate pred) const
+{
+    constexpr bool parallel = arrayParallel::runsInParallel<Policy>;
+    std::vector<std::pair<const T *, size_t>> spans;
+    forEachChunk([&](const T *data, size_t n) { spans.emplace_back(data, n); });
+    // chunks hold about the same number of elements, so splitting the list of chunks balances the threads
+    std::vector<size_t> partial(parallel ? std::clamp<size_t>(spans.size(), 1, arrayParallel::chunksFor(length())) : 1);
+    arrayParallel::forChunks(spans.size(), partial.size(), [&](size_t begin, size_t end, unsigned piece) {
+        size_t output = 0;
+        for(size_t s = begin; s < end; ++s)
+            for(size_t i = 0; i < spans[s].second; ++i)
+                output += static_cast<bool>(std::invoke(pred, spans[s].first[i]));
+        partial[piece] = output;
+    });
+    size_t output = 0;
+    for(size_t count: partial)
+        output += count;
+    return output;
+}
+
+template <typename T>
+std::string myRope<T>::str(std::string del) const
+{
+    std::ostringstream output;
+    bool first = true;
+    for(const T &element: *this)
+    {
+        if(!first)
+            output << del;
+        output << element;
+        first = false;
+    }
+    return output.str();
+}
@@ -0,0 +1,140 @@
+#include "myRope_class.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+
+std::string contents(const myRope<char> &rope)
+{
+    return std::string(rope.begin(), rope.end());
+}
+
+TEST(MyRopeTest, DefaultConstructor)
+{
+    myRope<int> rope;
+    EXPECT_EQ(rope.length(), 0);
+    EXPECT_TRUE(rope.empty());
+    EXPECT_EQ(rope.chunks(), 0);
+    EXPECT_THROW(rope.at(0), std::out_of_range);
+}
+
+TEST(MyRopeTest, ArrayConstructorAndAccess)
+{
+    std::string text(10000, 'A');
+    for(size_t i = 0; i < text.size(); ++i)
+        text[i] = "ACGT"[i * 7 % 4];
+    myRope<char> rope(text.data(), text.size());
+    EXPECT_EQ(rope.length(), 10000);
+    EXPECT_GT(rope.chunks(), 1);
+    EXPECT_EQ(rope.at(1234), text[1234]);
+    EXPECT_EQ(rope.at(-1), text.back());
+    EXPECT_EQ(rope(9999), text[9999]);
+    EXPECT_EQ(contents(rope), text);
+    EXPECT_THROW(rope.at(10000), std::out_of_range);
+}
+
+TEST(MyRopeTest, InsertAndErase)
+{
+    myRope<char> rope;
+    std::string reference;
+    std::srand(3);
+    for(int step = 0; step < 3000; ++step)
+    {
+        size_t pos = std::rand() % (reference.size() + 1);
+        if(std::rand() % 3 != 0 || reference.size() < 10)
+        {
+            std::string bases(std::rand() % 20 + 1, "ACGT"[step % 4]);
+            rope.insert(pos, bases.begin(), bases.end());
+            reference.insert(pos, bases);
+        }
+        else
+        {
+            size_t count = std::rand() % 30;
+            rope.erase(pos, count);
+            reference.erase(pos, count);
+        }
+    }
+    EXPECT_EQ(rope.length(), reference.size());
+    EXPECT_EQ(contents(rope), reference);
+    rope.insert(0, 3, 'N');
+    reference.insert(0, 3, 'N');
+    rope.append('U');
+    reference.push_back('U');
+    EXPECT_EQ(contents(rope), reference);
+    EXPECT_THROW(rope.insert(reference.size() + 1, 1, 'A'), std::out_of_range);
+}
+
+TEST(MyRopeTest, SmallEditsDoNotFragment)
+{
+    std::string text(4096, 'A');
+    myRope<char> rope(text.data(), text.size());
+    size_t before = rope.chunks();
+    for(int i = 0; i < 1000; ++i)
+        rope.insert(2000 + i, 1, 'C');
+    for(int i = 0; i < 1000; ++i)
+        rope.erase(2000);
+    EXPECT_EQ(contents(rope), text);
+    EXPECT_LE(rope.chunks(), before + 2);
+}
+
+TEST(MyRopeTest, SplitAndConcat)
+{
+    std::string text = "ATGCGTACGTAGATGCCCTGA";
+    myRope<char> rope(text.data(), text.size());
+    myRope<char> tail = rope.split(9);
+    EXPECT_EQ(contents(rope), "ATGCGTACG");
+    EXPECT_EQ(contents(tail), "TAGATGCCCTGA");
+    myRope<char> copy(rope);
+    rope += std::move(tail);
+    EXPECT_EQ(contents(rope), text);
+    EXPECT_EQ(contents(copy), "ATGCGTACG");
+    EXPECT_THROW(rope.split(100), std::out_of_range);
+}
+
+TEST(MyRopeTest, ChunkScansAndIterators)
+{
+    auto threshold = parallelSettings::threshold;
+    auto threads = parallelSettings::threads;
+    parallelSettings::threshold = 1000;
+    parallelSettings::threads = 4;
+
+    std::vector<int> values(50000);
+    for(size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<int>(i % 10);
+    myRope<int> rope(values.data(), values.size());
+    size_t seen = 0;
+    rope.forEachChunk([&](const int *, size_t n) { seen += n; });
+    EXPECT_EQ(seen, values.size());
+    auto isSeven = [](int n) { return n == 7; };
+    EXPECT_EQ(rope.countIf(isSeven), 5000);
+    EXPECT_EQ(rope.countIf(arrayParallel::par, isSeven), 5000);
+
+    static_assert(std::random_access_iterator<myRope<int>::iterator>);
+    static_assert(std::ranges::random_access_range<const myRope<int>>);
+    EXPECT_TRUE(std::equal(rope.begin(), rope.end(), values.begin(), values.end()));
+    EXPECT_TRUE(std::equal(rope.rbegin(), rope.rend(), values.rbegin(), values.rend()));
+    *(rope.begin() + 12345) = 42;
+    EXPECT_EQ(rope.at(12345), 42);
+
+    parallelSettings::threshold = threshold;
+    parallelSettings::threads = threads;
+}
+
+TEST(MyRopeTest, AppendsFillTheLastChunk)
+{
+    myRope<char> rope;
+    std::string reference;
+    for(size_t i = 0; i < 20000; ++i)
+    {
+        rope.append("ACGT"[i % 4]);
+        reference.push_back("ACGT"[i % 4]);
+    }
+    EXPECT_EQ(contents(rope), reference);
+    EXPECT_EQ(rope.length(), reference.size());
+    EXPECT_EQ(rope.chunks(), (reference.size() + 4095) / 4096);
+    rope.erase(4000, 200);
+    reference.erase(4000, 200);
+    rope.append('N');
+    reference.push_back('N');
+    EXPECT_EQ(contents(rope), reference);
+}